@@ -18,7 +18,8 @@
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
-#include "itkBinaryMedianImageFilter.h"
+#include "itkRunningSumBinaryMedianImageFilter.h"
+#include "itkCropToForegroundImageFilter.h"
 #include "itkImage.h"
 
 
@@ -47,7 +48,7 @@ main(int argc, char ** argv)
   using WriterType = itk::ImageFileWriter<ImageType>;
 
 
-  using FilterType = itk::BinaryMedianImageFilter<ImageType, ImageType>;
+  using FilterType = itk::RunningSumBinaryMedianImageFilter<ImageType, ImageType>;
 
   auto filter = FilterType::New();
 
@@ -67,6 +68,16 @@ main(int argc, char ** argv)
   filter->SetForegroundValue(255);
 
 
+  // The median only runs on the bounding box of the foreground, with a
+  // margin of one pixel that it turns to background.
+  using CropFilterType = itk::CropToForegroundImageFilter<ImageType, ImageType>;
+
+  auto cropFilter = CropFilterType::New();
+
+  cropFilter->SetFilter(filter);
+  cropFilter->SetForegroundValue(255);
+
+
   auto reader = ReaderType::New();
   auto writer = WriterType::New();
 
@@ -80,9 +91,9 @@ main(int argc, char ** argv)
   writer->SetFileName(outputFilename);
 
 
-  filter->SetInput(reader->GetOutput());
+  cropFilter->SetInput(reader->GetOutput());
 
-  writer->SetInput(filter->GetOutput());
+  writer->SetInput(cropFilter->GetOutput());
 
 
   try
@@ -4,6 +4,7 @@
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 #include "itkBinaryThresholdImageFilter.h"
+#include "itkStreamingMemoryBudget.h"
 
 
 int
@@ -12,7 +13,8 @@ main(int argc, char * argv[])
 
   if (argc < 5)
   {
-    std::cerr << "BinaryThresholdFilter  inputFile outputFile lowerThreshold upperThreshold" << std::endl;
+    std::cerr << "BinaryThresholdFilter  inputFile outputFile lowerThreshold upperThreshold [memoryBudgetMB]"
+              << std::endl;
     return -1;
   }
 
@@ -38,7 +40,7 @@ main(int argc, char * argv[])
 
   try
   {
-    imageReader->Update();
+    imageReader->UpdateOutputInformation();
   }
   catch (const itk::ExceptionObject & excp)
   {
@@ -59,21 +61,20 @@ main(int argc, char * argv[])
   filter->SetUpperThreshold(upperThreshold);
 
 
-  try
-  {
-    filter->Update();
-  }
-  catch (const itk::ExceptionObject & excp)
-  {
-    std::cerr << excp << std::endl;
-    return -1;
-  }
+  const double       memoryBudget = (argc > 5) ? atof(argv[5]) : 0.0;
+  const unsigned int numberOfDivisions =
+    itk::ComputeNumberOfStreamDivisions(imageReader->GetOutput()->GetLargestPossibleRegion(),
+                                        sizeof(InputPixelType) + sizeof(OutputPixelType),
+                                        memoryBudget);
+
+  std::cout << "Processing in " << numberOfDivisions << " slabs" << std::endl;
 
   auto imageWriter = ImageWriterType::New();
 
   imageWriter->SetFileName(argv[2]);
 
   imageWriter->SetInput(filter->GetOutput());
+  imageWriter->SetNumberOfStreamDivisions(numberOfDivisions);
 
 
   try
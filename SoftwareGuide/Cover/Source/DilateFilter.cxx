@@ -18,8 +18,8 @@
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
-#include "itkBinaryDilateImageFilter.h"
-#include "itkBinaryBallStructuringElement.h"
+#include "itkFastBinaryBallDilateImageFilter.h"
+#include "itkCropToForegroundImageFilter.h"
 #include "itkImage.h"
 
 
@@ -32,7 +32,7 @@ main(int argc, char ** argv)
   {
     std::cerr << "Usage: " << std::endl;
     std::cerr << argv[0] << " inputImageFile  outputImageFile " << std::endl;
-    std::cerr << " radius " << std::endl;
+    std::cerr << " radius [minimumDistanceTransformRadius]" << std::endl;
     return -1;
   }
 
@@ -48,22 +48,35 @@ main(int argc, char ** argv)
   using WriterType = itk::ImageFileWriter<ImageType>;
 
 
-  using StructuringElementType = itk::BinaryBallStructuringElement<PixelType, Dimension>;
-
-  using FilterType = itk::BinaryDilateImageFilter<ImageType, ImageType, StructuringElementType>;
+  using FilterType = itk::FastBinaryBallDilateImageFilter<ImageType, ImageType>;
 
   auto filter = FilterType::New();
 
 
   unsigned int radius = atoi(argv[3]);
 
-  StructuringElementType structuringElement;
+  filter->SetRadius(radius);
+
+  // Smaller balls are dilated directly, larger ones through the distance
+  // transform.
+  if (argc > 4)
+  {
+    filter->SetMinimumDistanceTransformRadius(atoi(argv[4]));
+  }
+
+
+  // The dilation only runs on the bounding box of the foreground, grown by
+  // the radius; the rest of the image is left as it is.
+  using CropFilterType = itk::CropToForegroundImageFilter<ImageType, ImageType>;
 
-  structuringElement.SetRadius(radius);
+  auto cropFilter = CropFilterType::New();
 
-  structuringElement.CreateStructuringElement();
+  ImageType::SizeType padding;
+  padding.Fill(radius);
 
-  filter->SetKernel(structuringElement);
+  cropFilter->SetFilter(filter);
+  cropFilter->SetPadding(padding);
+  cropFilter->CopyInputOutsideOn();
 
 
   auto reader = ReaderType::New();
@@ -76,9 +89,9 @@ main(int argc, char ** argv)
   writer->SetFileName(outputFilename);
 
 
-  filter->SetInput(reader->GetOutput());
+  cropFilter->SetInput(reader->GetOutput());
 
-  writer->SetInput(filter->GetOutput());
+  writer->SetInput(cropFilter->GetOutput());
 
 
   try
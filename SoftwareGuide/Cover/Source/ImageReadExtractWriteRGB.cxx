@@ -21,6 +21,7 @@
 #include "itkRegionOfInterestImageFilter.h"
 #include "itkImage.h"
 #include "itkRGBPixel.h"
+#include "itkStreamingMemoryBudget.h"
 
 
 int
@@ -32,7 +33,7 @@ main(int argc, char ** argv)
   {
     std::cerr << "Usage: " << std::endl;
     std::cerr << argv[0] << " inputImageFile  outputImageFile " << std::endl;
-    std::cerr << " startX startY startZ sizeX sizeY sizeZ" << std::endl;
+    std::cerr << " startX startY startZ sizeX sizeY sizeZ [memoryBudgetMB]" << std::endl;
     return -1;
   }
 
@@ -98,6 +99,16 @@ main(int argc, char ** argv)
   writer->SetInput(filter->GetOutput());
 
 
+  //
+  // Only the extracted region is read, one slab at a time when a memory
+  // budget is given. The ROI slab and the output slab coexist.
+  //
+  const double memoryBudget = (argc > 9) ? atof(argv[9]) : 0.0;
+
+  writer->SetNumberOfStreamDivisions(
+    itk::ComputeNumberOfStreamDivisions(wantedRegion, 2 * sizeof(PixelType), memoryBudget));
+
+
   try
   {
     writer->Update();
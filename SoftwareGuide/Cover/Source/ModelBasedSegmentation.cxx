@@ -21,12 +21,26 @@
 #include "itkImageToSpatialObjectMetric.h"
 #include "itkLinearInterpolateImageFunction.h"
 #include "itkTranslationTransform.h"
+#include "itkMatrixOffsetTransformBase.h"
+#include "itkMath.h"
+#include "itkGradientRecursiveGaussianImageFilter.h"
+#include "itkRegularStepGradientDescentOptimizer.h"
+#include "itkLBFGSOptimizer.h"
 #include "itkOnePlusOneEvolutionaryOptimizer.h"
-#include "itkDiscreteGaussianImageFilter.h"
+#include "itkMultiResolutionPyramidImageFilter.h"
 #include "itkNormalVariateGenerator.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 #include "itkCommand.h"
+#include "itkSingleValuedNonLinearOptimizer.h"
+#include "itkMultiThreaderBase.h"
+#include "itkImageRegionSplitterSlowDimension.h"
+
+#include <algorithm>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <vector>
 
 
 template <class TOptimizer>
@@ -92,6 +106,325 @@ protected:
 };
 
 
+//
+// (1+lambda) evolution strategy.
+//
+// Each iteration draws lambda offspring around the parent from the normal
+// variate generator, evaluates them concurrently and keeps the best one if
+// it improves on the parent. The search covariance grows on success and
+// shrinks on failure along the direction of the best offspring, with the
+// same update as OnePlusOneEvolutionaryOptimizer; with one offspring the
+// two optimizers take the same steps.
+//
+// The variates are drawn in offspring order before the batch is evaluated
+// and ties go to the lowest offspring, so with a fixed seed the result does
+// not depend on the number of work units. The cost function must allow
+// concurrent GetValue calls.
+//
+class OnePlusLambdaEvolutionaryOptimizer : public itk::SingleValuedNonLinearOptimizer
+{
+public:
+  /** Standard class type aliases. */
+  using Self = OnePlusLambdaEvolutionaryOptimizer;
+  using Superclass = itk::SingleValuedNonLinearOptimizer;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+
+  using NormalVariateGeneratorType = itk::Statistics::RandomVariateGeneratorBase;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(OnePlusLambdaEvolutionaryOptimizer);
+
+  /** Maximize the cost function instead of minimizing it. */
+  itkSetMacro(Maximize, bool);
+  itkGetConstReferenceMacro(Maximize, bool);
+  itkBooleanMacro(Maximize);
+
+  itkSetMacro(MaximumIteration, unsigned int);
+  itkGetConstReferenceMacro(MaximumIteration, unsigned int);
+
+  /** Number of offspring evaluated per iteration. */
+  itkSetClampMacro(NumberOfOffspring, unsigned int, 1, itk::NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfOffspring, unsigned int);
+
+  /** Number of work units evaluating the offspring. */
+  itkSetClampMacro(NumberOfWorkUnits, itk::ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfWorkUnits, itk::ThreadIdType);
+
+  itkSetMacro(GrowthFactor, double);
+  itkGetConstReferenceMacro(GrowthFactor, double);
+
+  itkSetMacro(ShrinkFactor, double);
+  itkGetConstReferenceMacro(ShrinkFactor, double);
+
+  itkSetMacro(InitialRadius, double);
+  itkGetConstReferenceMacro(InitialRadius, double);
+
+  /** Stop when the Frobenius norm of the covariance falls below Epsilon. */
+  itkSetMacro(Epsilon, double);
+  itkGetConstReferenceMacro(Epsilon, double);
+
+  itkGetConstReferenceMacro(FrobeniusNorm, double);
+  itkGetConstReferenceMacro(CurrentCost, MeasureType);
+  itkGetConstReferenceMacro(CurrentIteration, unsigned int);
+
+  MeasureType
+  GetValue() const
+  {
+    return this->GetCurrentCost();
+  }
+
+  void
+  SetNormalVariateGenerator(NormalVariateGeneratorType * generator)
+  {
+    if (m_RandomGenerator != generator)
+    {
+      m_RandomGenerator = generator;
+      this->Modified();
+    }
+  }
+
+  /** Same meaning and defaults as OnePlusOneEvolutionaryOptimizer::Initialize. */
+  void
+  Initialize(double initialRadius, double grow = -1, double shrink = -1)
+  {
+    m_InitialRadius = initialRadius;
+    m_GrowthFactor = grow == -1 ? 1.05 : grow;
+    m_ShrinkFactor = shrink == -1 ? std::pow(m_GrowthFactor, -0.25) : shrink;
+  }
+
+  void
+  StartOptimization() override
+  {
+    if (this->m_CostFunction.IsNull())
+    {
+      return;
+    }
+    if (!m_RandomGenerator)
+    {
+      itkExceptionMacro("Random Generator is not set!");
+    }
+
+    this->InvokeEvent(itk::StartEvent());
+    m_Stop = false;
+    m_StopConditionDescription.str("");
+
+    const unsigned int spaceDimension = this->m_CostFunction->GetNumberOfParameters();
+
+    const ScalesType & scales = this->GetScales();
+    if (scales.size() != spaceDimension)
+    {
+      itkExceptionMacro("The size of Scales is " << scales.size()
+                                                 << ", but the NumberOfParameters for the CostFunction is "
+                                                 << spaceDimension << '.');
+    }
+
+    // Search covariance, row major.
+    std::vector<double> A(spaceDimension * spaceDimension, 0.0);
+    for (unsigned int i = 0; i < spaceDimension; ++i)
+    {
+      A[i * spaceDimension + i] = m_InitialRadius / scales[i];
+    }
+
+    ParametersType parent = this->GetInitialPosition();
+    MeasureType    parentValue = this->m_CostFunction->GetValue(parent);
+    this->SetCurrentPosition(parent);
+    m_CurrentCost = parentValue;
+
+    const unsigned int              numberOfOffspring = m_NumberOfOffspring;
+    std::vector<double>             variates(numberOfOffspring * spaceDimension);
+    std::vector<double>             deltas(numberOfOffspring * spaceDimension);
+    std::vector<ParametersType>     offspring(numberOfOffspring, ParametersType(spaceDimension));
+    std::vector<MeasureType>        values(numberOfOffspring);
+    std::vector<std::exception_ptr> errors(numberOfOffspring);
+
+    auto multiThreader = itk::MultiThreaderBase::New();
+    multiThreader->SetNumberOfWorkUnits(m_NumberOfWorkUnits);
+
+    m_CurrentIteration = 0;
+    for (unsigned int iter = 0; iter < m_MaximumIteration; ++iter)
+    {
+      if (m_Stop)
+      {
+        m_StopConditionDescription << "StopOptimization() called";
+        break;
+      }
+      ++m_CurrentIteration;
+
+      for (unsigned int k = 0; k < numberOfOffspring; ++k)
+      {
+        double * f = &variates[k * spaceDimension];
+        double * delta = &deltas[k * spaceDimension];
+        for (unsigned int i = 0; i < spaceDimension; ++i)
+        {
+          f[i] = m_RandomGenerator->GetVariate();
+        }
+        for (unsigned int r = 0; r < spaceDimension; ++r)
+        {
+          delta[r] = 0.0;
+          for (unsigned int c = 0; c < spaceDimension; ++c)
+          {
+            delta[r] += A[r * spaceDimension + c] * f[c];
+          }
+          offspring[k][r] = parent[r] + delta[r];
+        }
+      }
+
+      multiThreader->ParallelizeArray(
+        0,
+        numberOfOffspring,
+        [&](itk::SizeValueType k) {
+          try
+          {
+            values[k] = this->m_CostFunction->GetValue(offspring[k]);
+          }
+          catch (...)
+          {
+            errors[k] = std::current_exception();
+          }
+        },
+        nullptr);
+
+      for (const auto & error : errors)
+      {
+        if (error)
+        {
+          m_StopConditionDescription << "Cost function error after " << m_CurrentIteration << " iterations";
+          std::rethrow_exception(error);
+        }
+      }
+
+      unsigned int best = 0;
+      for (unsigned int k = 1; k < numberOfOffspring; ++k)
+      {
+        if (m_Maximize ? values[k] > values[best] : values[k] < values[best])
+        {
+          best = k;
+        }
+      }
+
+      double adjust = m_ShrinkFactor;
+      if (m_Maximize ? values[best] > parentValue : values[best] < parentValue)
+      {
+        parent = offspring[best];
+        parentValue = values[best];
+        adjust = m_GrowthFactor;
+        this->SetCurrentPosition(parent);
+      }
+
+      double frobeniusNorm = 0.0;
+      for (const double a : A)
+      {
+        frobeniusNorm += a * a;
+      }
+      m_FrobeniusNorm = std::sqrt(frobeniusNorm);
+      m_CurrentCost = parentValue;
+
+      if (m_FrobeniusNorm <= m_Epsilon)
+      {
+        m_StopConditionDescription << "Fnorm (" << m_FrobeniusNorm << ") is less than Epsilon (" << m_Epsilon
+                                   << " at iteration #" << m_CurrentIteration;
+        break;
+      }
+
+      // A := A + (adjust - 1) * (A f) f^T / |f|^2 for the best offspring.
+      const double * f = &variates[best * spaceDimension];
+      const double * delta = &deltas[best * spaceDimension];
+      double         squaredNorm = 0.0;
+      for (unsigned int i = 0; i < spaceDimension; ++i)
+      {
+        squaredNorm += f[i] * f[i];
+      }
+      const double alpha = (adjust - 1.0) / squaredNorm;
+      for (unsigned int r = 0; r < spaceDimension; ++r)
+      {
+        for (unsigned int c = 0; c < spaceDimension; ++c)
+        {
+          A[r * spaceDimension + c] += alpha * delta[r] * f[c];
+        }
+      }
+
+      this->InvokeEvent(itk::IterationEvent());
+    }
+
+    if (m_CurrentIteration == m_MaximumIteration)
+    {
+      m_StopConditionDescription << "Maximum number of iterations (" << m_MaximumIteration << ") exceeded.";
+    }
+    this->InvokeEvent(itk::EndEvent());
+  }
+
+  void
+  StopOptimization()
+  {
+    m_Stop = true;
+  }
+
+  std::string
+  GetStopConditionDescription() const override
+  {
+    return m_StopConditionDescription.str();
+  }
+
+protected:
+  OnePlusLambdaEvolutionaryOptimizer()
+  {
+    m_NumberOfWorkUnits = itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+    this->Initialize(1.01);
+  }
+  ~OnePlusLambdaEvolutionaryOptimizer() override = default;
+
+  void
+  PrintSelf(std::ostream & os, itk::Indent indent) const override
+  {
+    Superclass::PrintSelf(os, indent);
+
+    os << indent << "Maximize: " << m_Maximize << std::endl;
+    os << indent << "MaximumIteration: " << m_MaximumIteration << std::endl;
+    os << indent << "NumberOfOffspring: " << m_NumberOfOffspring << std::endl;
+    os << indent << "NumberOfWorkUnits: " << m_NumberOfWorkUnits << std::endl;
+    os << indent << "GrowthFactor: " << m_GrowthFactor << std::endl;
+    os << indent << "ShrinkFactor: " << m_ShrinkFactor << std::endl;
+    os << indent << "InitialRadius: " << m_InitialRadius << std::endl;
+    os << indent << "Epsilon: " << m_Epsilon << std::endl;
+    os << indent << "FrobeniusNorm: " << m_FrobeniusNorm << std::endl;
+    os << indent << "CurrentCost: " << m_CurrentCost << std::endl;
+    os << indent << "CurrentIteration: " << m_CurrentIteration << std::endl;
+  }
+
+private:
+  NormalVariateGeneratorType::Pointer m_RandomGenerator;
+
+  bool              m_Maximize{ false };
+  unsigned int      m_MaximumIteration{ 100 };
+  unsigned int      m_NumberOfOffspring{ 1 };
+  itk::ThreadIdType m_NumberOfWorkUnits{ 1 };
+  double            m_GrowthFactor{ 1.05 };
+  double            m_ShrinkFactor{ 1.0 };
+  double            m_InitialRadius{ 1.01 };
+  double            m_Epsilon{ 1.5e-4 };
+
+  double             m_FrobeniusNorm{ 0.0 };
+  MeasureType        m_CurrentCost{ 0.0 };
+  unsigned int       m_CurrentIteration{ 0 };
+  bool               m_Stop{ false };
+  std::ostringstream m_StopConditionDescription;
+};
+
+
+//
+// Sums the fixed image intensities at the transformed points inside the
+// moving spatial object, optionally through an interpolator and with the
+// derivative along the transform parameters.
+//
+// The points are summed in fixed blocks whose partial sums are added in
+// block order, so the value does not depend on the number of work units.
+// GetValue leaves the metric unchanged; with one work unit several
+// positions can be evaluated concurrently.
+//
 template <typename TFixedImage, typename TMovingSpatialObject>
 class SimpleImageToSpatialObjectMetric : public itk::ImageToSpatialObjectMetric<TFixedImage, TMovingSpatialObject>
 {
@@ -106,13 +439,32 @@ public:
   itkStaticConstMacro(ImageDimension, unsigned int, TFixedImage::ImageDimension);
 
   using PointType = itk::Point<double, ImageDimension>;
-  using PointListType = std::list<PointType>;
+  using CoordinateContainerType = std::vector<double>;
   using MovingSpatialObjectType = TMovingSpatialObject;
   using ParametersType = typename Superclass::ParametersType;
   using DerivativeType = typename Superclass::DerivativeType;
   using MeasureType = typename Superclass::MeasureType;
+  using TransformType = typename Superclass::TransformType;
+  using TransformPointer = typename Superclass::TransformPointer;
   using IndexType = typename TFixedImage::IndexType;
+  using IndexValueType = typename IndexType::IndexValueType;
   using RegionType = typename TFixedImage::RegionType;
+  using IndexContainerType = std::vector<IndexValueType>;
+  using OffsetContainerType = std::vector<itk::OffsetValueType>;
+
+  using JacobianType = typename TransformType::JacobianType;
+  using GradientPixelType = itk::CovariantVector<double, ImageDimension>;
+  using GradientImageType = itk::Image<GradientPixelType, ImageDimension>;
+
+  using InterpolatorType = typename Superclass::InterpolatorType;
+  using ContinuousIndexType = itk::ContinuousIndex<double, ImageDimension>;
+  using LinearInterpolatorType = itk::LinearInterpolateImageFunction<TFixedImage, double>;
+
+  using TranslationTransformType = itk::TranslationTransform<double, ImageDimension>;
+  using MatrixOffsetTransformType = itk::MatrixOffsetTransformBase<double, ImageDimension, ImageDimension>;
+
+  /** Number of points summed by one work item. */
+  static constexpr itk::SizeValueType PointsPerBlock = 4096;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -125,7 +477,40 @@ public:
     SpaceDimension = 3
   };
 
-  /** Connect the MovingSpatialObject */
+  /** Number of work units used by GetValue. */
+  void
+  SetNumberOfWorkUnits(itk::ThreadIdType numberOfWorkUnits)
+  {
+    m_NumberOfWorkUnits =
+      std::max<itk::ThreadIdType>(1, std::min<itk::ThreadIdType>(numberOfWorkUnits, ITK_MAX_THREADS));
+    m_MultiThreader->SetNumberOfWorkUnits(m_NumberOfWorkUnits);
+    this->Modified();
+  }
+  itkGetConstMacro(NumberOfWorkUnits, itk::ThreadIdType);
+
+  /** Use the index-space paths for translation and affine transforms. On by default. */
+  itkSetMacro(UseTransformFastPath, bool);
+  itkGetConstMacro(UseTransformFastPath, bool);
+  itkBooleanMacro(UseTransformFastPath);
+
+  /** Compute the fixed image gradient when the moving spatial object is
+   * set. Required by GetDerivative and GetValueAndDerivative. Off by default. */
+  itkSetMacro(ComputeGradient, bool);
+  itkGetConstMacro(ComputeGradient, bool);
+  itkBooleanMacro(ComputeGradient);
+
+  itkGetConstObjectMacro(GradientImage, GradientImageType);
+
+  /** Sample the intensities with the interpolator instead of at the
+   * nearest voxel. Off by default. */
+  itkSetMacro(UseInterpolator, bool);
+  itkGetConstMacro(UseInterpolator, bool);
+  itkBooleanMacro(UseInterpolator);
+
+  /** Connect the MovingSpatialObject. Only the voxels of the fixed region
+   * in the bounding box of the object are scanned, in slabs along the
+   * slowest dimension tested in parallel; the hits of the slabs are
+   * concatenated in slab order, the order of a serial scan. */
   void
   SetMovingSpatialObject(const MovingSpatialObjectType * object)
   {
@@ -135,7 +520,17 @@ public:
       return;
     }
     this->m_MovingSpatialObject = object;
-    this->m_PointList.clear();
+    m_GradientImage = nullptr;
+    if (m_ComputeGradient)
+    {
+      this->ComputeGradient();
+    }
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      m_PointCoordinates[d].clear();
+      m_PointIndices[d].clear();
+    }
+    m_PointOffsets.clear();
     using myIteratorType = itk::ImageRegionConstIteratorWithIndex<TFixedImage>;
 
     RegionType region;
@@ -148,34 +543,89 @@ public:
       region = this->m_FixedImage->GetBufferedRegion();
     }
 
-    myIteratorType it(this->m_FixedImage, region);
+    unsigned int numberOfPieces = 0;
+    auto         splitter = itk::ImageRegionSplitterSlowDimension::New();
+    if (this->CropToObjectBoundingBox(region))
+    {
+      // More slabs than work units, the object rarely fills its box evenly.
+      numberOfPieces = splitter->GetNumberOfSplits(region, 4 * m_NumberOfWorkUnits);
+    }
+
+    std::vector<std::vector<IndexType>> pieceIndices(numberOfPieces);
+
+    m_MultiThreader->ParallelizeArray(
+      0,
+      numberOfPieces,
+      [&](itk::SizeValueType piece) {
+        RegionType pieceRegion = region;
+        splitter->GetSplit(piece, numberOfPieces, pieceRegion);
+
+        PointType point;
+        for (myIteratorType it(this->m_FixedImage, pieceRegion); !it.IsAtEnd(); ++it)
+        {
+          this->m_FixedImage->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+          if (this->m_MovingSpatialObject->IsInside(point))
+          {
+            pieceIndices[piece].push_back(it.GetIndex());
+          }
+        }
+      },
+      nullptr);
+
+    itk::SizeValueType numberOfPoints = 0;
+    for (const auto & indices : pieceIndices)
+    {
+      numberOfPoints += indices.size();
+    }
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      m_PointCoordinates[d].reserve(numberOfPoints);
+      m_PointIndices[d].reserve(numberOfPoints);
+    }
+    m_PointOffsets.reserve(numberOfPoints);
 
-    PointType point;
+    m_PointIndexMinimum.Fill(itk::NumericTraits<IndexValueType>::max());
+    m_PointIndexMaximum.Fill(itk::NumericTraits<IndexValueType>::NonpositiveMin());
 
-    while (!it.IsAtEnd())
+    PointType point;
+    for (const auto & indices : pieceIndices)
     {
-      this->m_FixedImage->TransformIndexToPhysicalPoint(it.GetIndex(), point);
-      if (this->m_MovingSpatialObject->IsInside(point))
+      for (const IndexType & index : indices)
       {
-        this->m_PointList.push_back(point);
+        this->m_FixedImage->TransformIndexToPhysicalPoint(index, point);
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          m_PointCoordinates[d].push_back(point[d]);
+          m_PointIndices[d].push_back(index[d]);
+          m_PointIndexMinimum[d] = std::min(m_PointIndexMinimum[d], index[d]);
+          m_PointIndexMaximum[d] = std::max(m_PointIndexMaximum[d], index[d]);
+        }
+        m_PointOffsets.push_back(this->m_FixedImage->ComputeOffset(index));
       }
-      ++it;
     }
 
-    std::cout << "Number of points in the metric = " << static_cast<unsigned long>(m_PointList.size()) << std::endl;
+    std::cout << "Number of points in the metric = " << static_cast<unsigned long>(this->GetNumberOfPoints())
+              << std::endl;
+  }
+
+  itk::SizeValueType
+  GetNumberOfPoints() const
+  {
+    return m_PointCoordinates[0].size();
   }
 
   unsigned int
   GetNumberOfParameters() const
   {
-    return SpaceDimension;
+    return this->m_Transform ? this->m_Transform->GetNumberOfParameters() : static_cast<unsigned int>(SpaceDimension);
   };
 
   /** Get the Derivatives of the Match Measure */
   void
-  GetDerivative(const ParametersType &, DerivativeType &) const
+  GetDerivative(const ParametersType & parameters, DerivativeType & derivative) const
   {
-    return;
+    MeasureType value;
+    this->GetValueAndDerivative(parameters, value, derivative);
   }
 
 
@@ -191,56 +641,773 @@ public:
   MeasureType
   GetValue(const ParametersType & parameters) const
   {
-    double value;
-    this->m_Transform->SetParameters(parameters);
+    if (m_UseInterpolator && !this->m_Interpolator)
+    {
+      itkExceptionMacro("UseInterpolator is on but no interpolator is set");
+    }
 
-    typename PointListType::const_iterator it = m_PointList.begin();
+    const TransformPointer transform = this->m_Transform->Clone();
+    transform->SetParameters(parameters);
 
-    typename TFixedImage::RegionType region = this->m_FixedImage->GetBufferedRegion();
+    const IndexMappingType mapping = this->ComputeIndexMapping(transform);
 
-    IndexType index;
+    const itk::SizeValueType numberOfPoints = this->GetNumberOfPoints();
+    const itk::SizeValueType numberOfBlocks = (numberOfPoints + PointsPerBlock - 1) / PointsPerBlock;
 
-    value = 0;
-    while (it != m_PointList.end())
-    {
-      PointType transformedPoint = this->m_Transform->TransformPoint(*it);
-      this->m_FixedImage->TransformPhysicalPointToIndex(transformedPoint, index);
-      if (region.IsInside(index))
+    std::vector<double> blockValues(numberOfBlocks, 0.0);
+
+    const auto * const buffer = this->m_FixedImage->GetBufferPointer();
+
+    this->ForEachBlock(numberOfBlocks, [&](itk::SizeValueType block) {
+      const itk::SizeValueType begin = block * PointsPerBlock;
+      const itk::SizeValueType end = std::min(begin + PointsPerBlock, numberOfPoints);
+
+      if (m_UseInterpolator)
       {
-        value += this->m_FixedImage->GetPixel(index);
+        blockValues[block] = this->InterpolateBlock(begin, end, mapping, transform);
+        return;
       }
-      it++;
+      double sum = 0;
+      auto   accumulate = [&](itk::SizeValueType, itk::OffsetValueType offset) { sum += buffer[offset]; };
+      this->VisitBlock(begin, end, mapping, transform, accumulate);
+      blockValues[block] = sum;
+    });
+
+    double value = 0;
+    for (const double blockValue : blockValues)
+    {
+      value += blockValue;
     }
     //    std::cout << "GetValue( " << parameters << " )  = " << value << std::endl;
     return value;
   }
 
-  /** Get Value and Derivatives for MultipleValuedOptimizers */
+  /** Get Value and Derivatives for MultipleValuedOptimizers. The smoothed
+   * gradient image is sampled at the voxels of the value, in the same pass,
+   * and chained with the transform Jacobian. It stays at the nearest voxel
+   * with UseInterpolator. */
   void
   GetValueAndDerivative(const ParametersType & parameters, MeasureType & Value, DerivativeType & Derivative) const
   {
-    Value = this->GetValue(parameters);
-    this->GetDerivative(parameters, Derivative);
+    if (!m_GradientImage)
+    {
+      itkExceptionMacro("No gradient image, call ComputeGradientOn() before setting the moving spatial object");
+    }
+    if (m_UseInterpolator && !this->m_Interpolator)
+    {
+      itkExceptionMacro("UseInterpolator is on but no interpolator is set");
+    }
+
+    const TransformPointer transform = this->m_Transform->Clone();
+    transform->SetParameters(parameters);
+
+    const IndexMappingType mapping = this->ComputeIndexMapping(transform);
+
+    const unsigned int       numberOfParameters = transform->GetNumberOfParameters();
+    const itk::SizeValueType numberOfPoints = this->GetNumberOfPoints();
+    const itk::SizeValueType numberOfBlocks = (numberOfPoints + PointsPerBlock - 1) / PointsPerBlock;
+
+    std::vector<double> blockValues(numberOfBlocks, 0.0);
+    std::vector<double> blockDerivatives(numberOfBlocks * numberOfParameters, 0.0);
+
+    const auto * const buffer = this->m_FixedImage->GetBufferPointer();
+    const auto * const gradient = m_GradientImage->GetBufferPointer();
+
+    // The Jacobian of a translation is the identity.
+    const bool isTranslation = dynamic_cast<const TranslationTransformType *>(transform.GetPointer()) != nullptr;
+
+    this->ForEachBlock(numberOfBlocks, [&](itk::SizeValueType block) {
+      const itk::SizeValueType begin = block * PointsPerBlock;
+      const itk::SizeValueType end = std::min(begin + PointsPerBlock, numberOfPoints);
+
+      double   sum = 0;
+      double * derivative = &blockDerivatives[block * numberOfParameters];
+
+      JacobianType jacobian;
+      PointType    point;
+
+      auto accumulate = [&](itk::SizeValueType i, itk::OffsetValueType offset) {
+        sum += buffer[offset];
+        const GradientPixelType & g = gradient[offset];
+        if (isTranslation)
+        {
+          for (unsigned int d = 0; d < ImageDimension; ++d)
+          {
+            derivative[d] += g[d];
+          }
+          return;
+        }
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          point[d] = m_PointCoordinates[d][i];
+        }
+        transform->ComputeJacobianWithRespectToParameters(point, jacobian);
+        for (unsigned int p = 0; p < numberOfParameters; ++p)
+        {
+          for (unsigned int d = 0; d < ImageDimension; ++d)
+          {
+            derivative[p] += g[d] * jacobian(d, p);
+          }
+        }
+      };
+      this->VisitBlock(begin, end, mapping, transform, accumulate);
+      blockValues[block] = m_UseInterpolator ? this->InterpolateBlock(begin, end, mapping, transform) : sum;
+    });
+
+    Value = 0;
+    Derivative = DerivativeType(numberOfParameters);
+    Derivative.Fill(0.0);
+    for (itk::SizeValueType block = 0; block < numberOfBlocks; ++block)
+    {
+      Value += blockValues[block];
+      for (unsigned int p = 0; p < numberOfParameters; ++p)
+      {
+        Derivative[p] += blockDerivatives[block * numberOfParameters + p];
+      }
+    }
   }
 
 protected:
-  SimpleImageToSpatialObjectMetric() { m_FixedImageRegionSetByUser = false; }
+  SimpleImageToSpatialObjectMetric()
+  {
+    m_FixedImageRegionSetByUser = false;
+    m_UseTransformFastPath = true;
+    m_ComputeGradient = false;
+    m_UseInterpolator = false;
+    m_MultiThreader = itk::MultiThreaderBase::New();
+    m_NumberOfWorkUnits = m_MultiThreader->GetNumberOfWorkUnits();
+  }
   ~SimpleImageToSpatialObjectMetric() {}
 
 private:
-  PointListType m_PointList;
+  /** Map from the stored point indices to the fixed image indices for the
+   * current transform parameters. */
+  struct IndexMappingType
+  {
+    enum
+    {
+      Generic,
+      Translation,
+      Affine
+    } path{ Generic };
+
+    /** Translation: continuous and rounded index shift, and the matching
+     * buffer offset shift. */
+    itk::Vector<double, ImageDimension> continuousShift;
+    IndexType                           shift{};
+    itk::OffsetValueType                linearShift{ 0 };
+
+    /** Affine: continuous index = matrix * point index + offset. */
+    itk::Matrix<double, ImageDimension, ImageDimension> matrix;
+    itk::Vector<double, ImageDimension>                 offset;
+
+    /** False when every mapped point is known to be in the buffer. */
+    bool checkBounds{ true };
+  };
+
+  /** Crop \a region to the voxels that can lie inside the moving spatial
+   * object. Returns false when none can. */
+  bool
+  CropToObjectBoundingBox(RegionType & region) const
+  {
+    const auto * boundingBox = this->m_MovingSpatialObject->GetMyBoundingBoxInWorldSpace();
+
+    IndexType lower;
+    IndexType upper;
+    lower.Fill(itk::NumericTraits<IndexValueType>::max());
+    upper.Fill(itk::NumericTraits<IndexValueType>::NonpositiveMin());
+
+    // With a rotated image direction the box corners are not the index
+    // extremes of the box, so bound all of them.
+    itk::ContinuousIndex<double, ImageDimension> continuousIndex;
+    for (const auto & corner : boundingBox->ComputeCorners())
+    {
+      this->m_FixedImage->TransformPhysicalPointToContinuousIndex(corner, continuousIndex);
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        lower[d] = std::min(lower[d], static_cast<IndexValueType>(std::floor(continuousIndex[d])));
+        upper[d] = std::max(upper[d], static_cast<IndexValueType>(std::ceil(continuousIndex[d])));
+      }
+    }
+
+    RegionType boundingRegion;
+    boundingRegion.SetIndex(lower);
+    boundingRegion.SetUpperIndex(upper);
+    return region.Crop(boundingRegion);
+  }
+
+  IndexMappingType
+  ComputeIndexMapping(const TransformType * transform) const
+  {
+    IndexMappingType mapping;
+    if (!m_UseTransformFastPath || this->GetNumberOfPoints() == 0)
+    {
+      return mapping;
+    }
+
+    const RegionType                   region = this->m_FixedImage->GetBufferedRegion();
+    const itk::OffsetValueType * const offsetTable = this->m_FixedImage->GetOffsetTable();
+    const auto &                       toIndex = this->m_FixedImage->GetPhysicalPointToIndexMatrix();
+
+    if (const auto * translation = dynamic_cast<const TranslationTransformType *>(transform))
+    {
+      // round(i + x) == i + round(x) for an integer index i.
+      mapping.continuousShift = toIndex * translation->GetOffset();
+
+      IndexType lower;
+      IndexType upper;
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        mapping.shift[d] = itk::Math::RoundHalfIntegerUp<IndexValueType>(mapping.continuousShift[d]);
+        mapping.linearShift += mapping.shift[d] * offsetTable[d];
+        lower[d] = m_PointIndexMinimum[d] + mapping.shift[d];
+        upper[d] = m_PointIndexMaximum[d] + mapping.shift[d];
+      }
+      mapping.checkBounds = !(region.IsInside(lower) && region.IsInside(upper));
+      mapping.path = IndexMappingType::Translation;
+      return mapping;
+    }
+
+    if (const auto * affine = dynamic_cast<const MatrixOffsetTransformType *>(transform))
+    {
+      // index' = toIndex * (A * (toPhysical * index + origin) + b - origin)
+      const auto & toPhysical = this->m_FixedImage->GetIndexToPhysicalPoint();
+      const auto   origin = this->m_FixedImage->GetOrigin().GetVectorFromOrigin();
+
+      mapping.matrix = toIndex * affine->GetMatrix() * toPhysical;
+      mapping.offset = toIndex * (affine->GetMatrix() * origin + affine->GetOffset() - origin);
+
+      // An affine map sends the bounding box of the points to a
+      // parallelepiped whose extremes are the images of the box corners.
+      mapping.checkBounds = false;
+      for (unsigned int corner = 0; corner < (1u << ImageDimension); ++corner)
+      {
+        IndexType mappedCorner;
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          double continuousIndex = mapping.offset[d];
+          for (unsigned int j = 0; j < ImageDimension; ++j)
+          {
+            const IndexValueType index = (corner >> j) & 1u ? m_PointIndexMaximum[j] : m_PointIndexMinimum[j];
+            continuousIndex += mapping.matrix[d][j] * index;
+          }
+          mappedCorner[d] = itk::Math::RoundHalfIntegerUp<IndexValueType>(continuousIndex);
+        }
+        if (!region.IsInside(mappedCorner))
+        {
+          mapping.checkBounds = true;
+          break;
+        }
+      }
+      mapping.path = IndexMappingType::Affine;
+    }
+    return mapping;
+  }
+
+  /** Call function(block) for every block of PointsPerBlock points, on the
+   * multithreader unless there is a single work unit. The inline loop keeps
+   * concurrent GetValue calls off the shared multithreader, which is not
+   * reentrant. */
+  template <typename TFunction>
+  void
+  ForEachBlock(itk::SizeValueType numberOfBlocks, const TFunction & function) const
+  {
+    if (m_NumberOfWorkUnits == 1 || numberOfBlocks <= 1)
+    {
+      for (itk::SizeValueType block = 0; block < numberOfBlocks; ++block)
+      {
+        function(block);
+      }
+      return;
+    }
+    m_MultiThreader->ParallelizeArray(0, numberOfBlocks, function, nullptr);
+  }
+
+  /** Call visitor(i, offset) for every point i in [begin, end) that maps
+   * into the buffer, with offset the buffer offset of its voxel.
+   *
+   * The points are voxel centres of the fixed image, so a translation is
+   * one index shift and a MatrixOffsetTransformBase one index-space affine
+   * map; both skip the virtual TransformPoint and the physical-to-index
+   * conversion, and the bounds test is compiled out when the mapped
+   * bounding box of the points lies in the buffer. They pick the voxels of
+   * the generic path except for points exactly half way between two. */
+  template <typename TVisitor>
+  void
+  VisitBlock(itk::SizeValueType       begin,
+             itk::SizeValueType       end,
+             const IndexMappingType & mapping,
+             const TransformType *    transform,
+             TVisitor &               visitor) const
+  {
+    switch (mapping.path)
+    {
+      case IndexMappingType::Translation:
+        if (mapping.checkBounds)
+        {
+          this->template VisitTranslatedBlock<true>(begin, end, mapping, visitor);
+        }
+        else
+        {
+          this->template VisitTranslatedBlock<false>(begin, end, mapping, visitor);
+        }
+        break;
+      case IndexMappingType::Affine:
+        if (mapping.checkBounds)
+        {
+          this->template VisitAffineBlock<true>(begin, end, mapping, visitor);
+        }
+        else
+        {
+          this->template VisitAffineBlock<false>(begin, end, mapping, visitor);
+        }
+        break;
+      default:
+        this->VisitTransformedBlock(begin, end, transform, visitor);
+    }
+  }
+
+  /** Translation path: one shifted gathered load per point. */
+  template <bool VCheckBounds, typename TVisitor>
+  void
+  VisitTranslatedBlock(itk::SizeValueType       begin,
+                       itk::SizeValueType       end,
+                       const IndexMappingType & mapping,
+                       TVisitor &               visitor) const
+  {
+    const RegionType           region = this->m_FixedImage->GetBufferedRegion();
+    const IndexType            start = region.GetIndex();
+    const auto                 size = region.GetSize();
+    const itk::OffsetValueType linearShift = mapping.linearShift;
+
+    for (itk::SizeValueType i = begin; i < end; ++i)
+    {
+      if (VCheckBounds)
+      {
+        bool inside = true;
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          const IndexValueType index = m_PointIndices[d][i] + mapping.shift[d];
+          inside = inside && static_cast<itk::SizeValueType>(index - start[d]) < size[d];
+        }
+        if (!inside)
+        {
+          continue;
+        }
+      }
+      visitor(i, m_PointOffsets[i] + linearShift);
+    }
+  }
+
+  /** Affine path: index-space matrix product and rounding per point. */
+  template <bool VCheckBounds, typename TVisitor>
+  void
+  VisitAffineBlock(itk::SizeValueType       begin,
+                   itk::SizeValueType       end,
+                   const IndexMappingType & mapping,
+                   TVisitor &               visitor) const
+  {
+    const itk::OffsetValueType * const offsetTable = this->m_FixedImage->GetOffsetTable();
+    const RegionType                   region = this->m_FixedImage->GetBufferedRegion();
+    const IndexType                    start = region.GetIndex();
+    const auto                         size = region.GetSize();
+
+    for (itk::SizeValueType i = begin; i < end; ++i)
+    {
+      itk::OffsetValueType linearOffset = 0;
+      bool                 inside = true;
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        double continuousIndex = mapping.offset[d];
+        for (unsigned int j = 0; j < ImageDimension; ++j)
+        {
+          continuousIndex += mapping.matrix[d][j] * m_PointIndices[j][i];
+        }
+        const IndexValueType local = itk::Math::RoundHalfIntegerUp<IndexValueType>(continuousIndex) - start[d];
+        if (VCheckBounds)
+        {
+          inside = inside && static_cast<itk::SizeValueType>(local) < size[d];
+        }
+        linearOffset += local * offsetTable[d];
+      }
+      if (VCheckBounds && !inside)
+      {
+        continue;
+      }
+      visitor(i, linearOffset);
+    }
+  }
+
+  /** Generic path: transform every point and convert it to an index. */
+  template <typename TVisitor>
+  void
+  VisitTransformedBlock(itk::SizeValueType    begin,
+                        itk::SizeValueType    end,
+                        const TransformType * transform,
+                        TVisitor &            visitor) const
+  {
+    const RegionType region = this->m_FixedImage->GetBufferedRegion();
+
+    PointType point;
+    IndexType index;
+
+    for (itk::SizeValueType i = begin; i < end; ++i)
+    {
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        point[d] = m_PointCoordinates[d][i];
+      }
+      const PointType transformedPoint = transform->TransformPoint(point);
+      this->m_FixedImage->TransformPhysicalPointToIndex(transformedPoint, index);
+      if (region.IsInside(index))
+      {
+        visitor(i, this->m_FixedImage->ComputeOffset(index));
+      }
+    }
+  }
+
+  /** Continuous fixed image indices of the transformed points [begin, end),
+   * one array per dimension. */
+  void
+  ComputeContinuousIndices(itk::SizeValueType       begin,
+                           itk::SizeValueType       end,
+                           const IndexMappingType & mapping,
+                           const TransformType *    transform,
+                           std::vector<double> *    continuousIndices) const
+  {
+    const itk::SizeValueType count = end - begin;
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      continuousIndices[d].resize(count);
+    }
+
+    switch (mapping.path)
+    {
+      case IndexMappingType::Translation:
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          const IndexValueType * index = &m_PointIndices[d][begin];
+          double *               c = continuousIndices[d].data();
+          const double           shift = mapping.continuousShift[d];
+          for (itk::SizeValueType k = 0; k < count; ++k)
+          {
+            c[k] = index[k] + shift;
+          }
+        }
+        break;
+      case IndexMappingType::Affine:
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          double * c = continuousIndices[d].data();
+          for (itk::SizeValueType k = 0; k < count; ++k)
+          {
+            c[k] = mapping.offset[d];
+          }
+          for (unsigned int j = 0; j < ImageDimension; ++j)
+          {
+            const IndexValueType * index = &m_PointIndices[j][begin];
+            const double           m = mapping.matrix[d][j];
+            for (itk::SizeValueType k = 0; k < count; ++k)
+            {
+              c[k] += m * index[k];
+            }
+          }
+        }
+        break;
+      default:
+      {
+        PointType           point;
+        ContinuousIndexType continuousIndex;
+        for (itk::SizeValueType k = 0; k < count; ++k)
+        {
+          for (unsigned int d = 0; d < ImageDimension; ++d)
+          {
+            point[d] = m_PointCoordinates[d][begin + k];
+          }
+          this->m_FixedImage->TransformPhysicalPointToContinuousIndex(transform->TransformPoint(point),
+                                                                      continuousIndex);
+          for (unsigned int d = 0; d < ImageDimension; ++d)
+          {
+            continuousIndices[d][k] = continuousIndex[d];
+          }
+        }
+      }
+    }
+  }
+
+  /** Sum of the interpolated intensities at the transformed points [begin, end).
+   * For a LinearInterpolateImageFunction the floors, clamped neighbour
+   * offsets and weights are computed dimension by dimension over flat
+   * arrays, which vectorize, and the corner values are then gathered from
+   * the buffer; the result equals Evaluate up to rounding. */
+  double
+  InterpolateBlock(itk::SizeValueType       begin,
+                   itk::SizeValueType       end,
+                   const IndexMappingType & mapping,
+                   const TransformType *    transform) const
+  {
+    const itk::SizeValueType count = end - begin;
+
+    std::vector<double> continuousIndices[ImageDimension];
+    this->ComputeContinuousIndices(begin, end, mapping, transform, continuousIndices);
+
+    const auto * linearInterpolator = dynamic_cast<const LinearInterpolatorType *>(this->m_Interpolator.GetPointer());
+    if (!linearInterpolator)
+    {
+      const InterpolatorType * interpolator = this->m_Interpolator;
+
+      ContinuousIndexType continuousIndex;
+      double              value = 0;
+      for (itk::SizeValueType k = 0; k < count; ++k)
+      {
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          continuousIndex[d] = continuousIndices[d][k];
+        }
+        if (interpolator->IsInsideBuffer(continuousIndex))
+        {
+          value += interpolator->EvaluateAtContinuousIndex(continuousIndex);
+        }
+      }
+      return value;
+    }
+
+    const auto * const                 buffer = this->m_FixedImage->GetBufferPointer();
+    const itk::OffsetValueType * const offsetTable = this->m_FixedImage->GetOffsetTable();
+    const RegionType                   region = this->m_FixedImage->GetBufferedRegion();
+
+    // Per point and dimension: the offsets of the lower and upper
+    // neighbours, clamped to the buffer as the interpolator does, and the
+    // weight of the upper one.
+    std::vector<itk::OffsetValueType> lowerOffsets(ImageDimension * count);
+    std::vector<itk::OffsetValueType> upperOffsets(ImageDimension * count);
+    std::vector<double>               upperWeights(ImageDimension * count);
+    std::vector<unsigned char>        inside(count, 1);
+
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      // The interpolator accepts continuous indices up to half a voxel
+      // outside the buffer.
+      const IndexValueType       first = region.GetIndex(d);
+      const IndexValueType       last = first + static_cast<IndexValueType>(region.GetSize(d)) - 1;
+      const double               lowerBound = first - 0.5;
+      const double               upperBound = last + 0.5;
+      const itk::OffsetValueType stride = offsetTable[d];
+
+      const double *         c = continuousIndices[d].data();
+      itk::OffsetValueType * lowerOffset = &lowerOffsets[d * count];
+      itk::OffsetValueType * upperOffset = &upperOffsets[d * count];
+      double *               upperWeight = &upperWeights[d * count];
+      for (itk::SizeValueType k = 0; k < count; ++k)
+      {
+        inside[k] &= static_cast<unsigned char>(c[k] >= lowerBound && c[k] < upperBound);
+        const double         clamped = std::min(std::max(c[k], lowerBound), upperBound);
+        const double         base = std::floor(clamped);
+        const IndexValueType lower = static_cast<IndexValueType>(base);
+        upperWeight[k] = clamped - base;
+        lowerOffset[k] = (std::max(lower, first) - first) * stride;
+        upperOffset[k] = (std::min(lower + 1, last) - first) * stride;
+      }
+    }
+
+    double value = 0;
+    for (itk::SizeValueType k = 0; k < count; ++k)
+    {
+      if (!inside[k])
+      {
+        continue;
+      }
+      for (unsigned int corner = 0; corner < (1u << ImageDimension); ++corner)
+      {
+        itk::OffsetValueType offset = 0;
+        double               weight = 1.0;
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          if ((corner >> d) & 1u)
+          {
+            offset += upperOffsets[d * count + k];
+            weight *= upperWeights[d * count + k];
+          }
+          else
+          {
+            offset += lowerOffsets[d * count + k];
+            weight *= 1.0 - upperWeights[d * count + k];
+          }
+        }
+        value += weight * buffer[offset];
+      }
+    }
+    return value;
+  }
+
+  /** Smoothed gradient of the fixed image, sampled by GetValueAndDerivative. */
+  void
+  ComputeGradient()
+  {
+    using GradientFilterType = itk::GradientRecursiveGaussianImageFilter<TFixedImage, GradientImageType>;
+
+    double maximumSpacing = 0.0;
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      maximumSpacing = std::max(maximumSpacing, this->m_FixedImage->GetSpacing()[d]);
+    }
+
+    auto gradientFilter = GradientFilterType::New();
+    gradientFilter->SetInput(this->m_FixedImage);
+    gradientFilter->SetSigma(maximumSpacing);
+    gradientFilter->SetNormalizeAcrossScale(true);
+    gradientFilter->SetNumberOfWorkUnits(m_NumberOfWorkUnits);
+    gradientFilter->Update();
+
+    // The gradient is read at the buffer offsets of the fixed image.
+    if (gradientFilter->GetOutput()->GetBufferedRegion() != this->m_FixedImage->GetBufferedRegion())
+    {
+      itkExceptionMacro("The gradient image does not cover the buffered region of the fixed image");
+    }
+    m_GradientImage = gradientFilter->GetOutput();
+  }
+
+  /** The points, one contiguous coordinate array per dimension, with their
+   * voxel indices and buffer offsets. */
+  CoordinateContainerType m_PointCoordinates[ImageDimension];
+  IndexContainerType      m_PointIndices[ImageDimension];
+  OffsetContainerType     m_PointOffsets;
+  IndexType               m_PointIndexMinimum;
+  IndexType               m_PointIndexMaximum;
 
   RegionType m_FixedImageRegion;
   bool       m_FixedImageRegionSetByUser;
+  bool       m_UseTransformFastPath;
+  bool       m_ComputeGradient;
+  bool       m_UseInterpolator;
+
+  typename GradientImageType::ConstPointer m_GradientImage;
+
+  itk::MultiThreaderBase::Pointer m_MultiThreader;
+  itk::ThreadIdType               m_NumberOfWorkUnits;
 };
 
 
+// Evolutionary optimizer maximizing the metric, reporting every iteration.
+template <typename TOptimizer>
+typename TOptimizer::Pointer
+CreateEvolutionaryOptimizer(itk::Statistics::NormalVariateGenerator * generator,
+                            const typename TOptimizer::ScalesType &   scales,
+                            double                                    initialRadius,
+                            unsigned int                              maximumIteration)
+{
+  auto optimizer = TOptimizer::New();
+
+  optimizer->SetNormalVariateGenerator(generator);
+  optimizer->Initialize(initialRadius);
+  optimizer->SetMaximumIteration(maximumIteration);
+  optimizer->SetScales(scales);
+  optimizer->MaximizeOn();
+
+  using IterationCallbackType = IterationCallback<TOptimizer>;
+
+  auto callback = IterationCallbackType::New();
+
+  callback->SetOptimizer(optimizer);
+
+  return optimizer;
+}
+
+
+// Gradient ascent on the metric, reporting every iteration.
+itk::RegularStepGradientDescentOptimizer::Pointer
+CreateGradientOptimizer(const itk::RegularStepGradientDescentOptimizer::ScalesType & scales,
+                        double                                                      maximumStepLength,
+                        unsigned int                                                numberOfIterations)
+{
+  using OptimizerType = itk::RegularStepGradientDescentOptimizer;
+
+  auto optimizer = OptimizerType::New();
+
+  optimizer->SetScales(scales);
+  optimizer->SetMaximumStepLength(maximumStepLength);
+  optimizer->SetMinimumStepLength(0.01);
+  optimizer->SetNumberOfIterations(numberOfIterations);
+  optimizer->MaximizeOn();
+
+  using IterationCallbackType = IterationCallback<OptimizerType>;
+
+  auto callback = IterationCallbackType::New();
+
+  callback->SetOptimizer(optimizer);
+
+  return optimizer;
+}
+
+
+// Quasi-Newton ascent on the metric. The vnl optimizers have no iteration
+// count to report, so no IterationCallback is attached.
+itk::LBFGSOptimizer::Pointer
+CreateLBFGSOptimizer(const itk::LBFGSOptimizer::ScalesType & scales,
+                     double                                  defaultStepLength,
+                     unsigned int                            numberOfEvaluations)
+{
+  auto optimizer = itk::LBFGSOptimizer::New();
+
+  optimizer->SetScales(scales);
+  optimizer->SetDefaultStepLength(defaultStepLength);
+  optimizer->SetMaximumNumberOfFunctionEvaluations(numberOfEvaluations);
+  optimizer->SetGradientConvergenceTolerance(1e-4);
+  optimizer->MaximizeOn();
+
+  return optimizer;
+}
+
+
+// Region of levelImage covering the physical extent of region in image.
+template <typename TImage>
+typename TImage::RegionType
+MapRegionToLevel(const typename TImage::RegionType & region, const TImage * image, const TImage * levelImage)
+{
+  constexpr unsigned int Dimension = TImage::ImageDimension;
+
+  typename TImage::IndexType lower;
+  typename TImage::IndexType upper;
+  lower.Fill(itk::NumericTraits<itk::IndexValueType>::max());
+  upper.Fill(itk::NumericTraits<itk::IndexValueType>::NonpositiveMin());
+
+  typename TImage::PointType              point;
+  itk::ContinuousIndex<double, Dimension> continuousIndex;
+  const typename TImage::IndexType        regionLower = region.GetIndex();
+  const typename TImage::IndexType        regionUpper = region.GetUpperIndex();
+  for (unsigned int corner = 0; corner < (1u << Dimension); ++corner)
+  {
+    typename TImage::IndexType index;
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      index[d] = (corner >> d) & 1u ? regionUpper[d] : regionLower[d];
+    }
+    image->TransformIndexToPhysicalPoint(index, point);
+    levelImage->TransformPhysicalPointToContinuousIndex(point, continuousIndex);
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      lower[d] = std::min(lower[d], static_cast<itk::IndexValueType>(std::floor(continuousIndex[d])));
+      upper[d] = std::max(upper[d], static_cast<itk::IndexValueType>(std::ceil(continuousIndex[d])));
+    }
+  }
+
+  typename TImage::RegionType levelRegion;
+  levelRegion.SetIndex(lower);
+  levelRegion.SetUpperIndex(upper);
+  levelRegion.Crop(levelImage->GetBufferedRegion());
+  return levelRegion;
+}
+
+
 int
 main(int argc, char * argv[])
 {
-  if (argc != 2)
+  if (argc < 2)
   {
-    std::cerr << "Usage: " << argv[0] << "InputImageFilename" << std::endl;
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " InputImageFilename [numberOfThreads [numberOfOffspring [numberOfLevels";
+    std::cerr << " [evolutionary|gradient|lbfgs [nearest|linear]]]]]" << std::endl;
+    return 1;
   }
 
 
@@ -264,27 +1431,18 @@ main(int argc, char * argv[])
 
 
   using RegistrationType = itk::ImageToSpatialObjectRegistrationMethod<ImageType, EllipseType>;
-
-  auto registration = RegistrationType::New();
-
-
   using MetricType = SimpleImageToSpatialObjectMetric<ImageType, EllipseType>;
-
-  auto metric = MetricType::New();
-
-
   using InterpolatorType = itk::LinearInterpolateImageFunction<ImageType, double>;
-
-  auto interpolator = InterpolatorType::New();
-
-
-  using OptimizerType = itk::OnePlusOneEvolutionaryOptimizer;
-
-  OptimizerType::Pointer optimizer = OptimizerType::New();
-
-
   using TransformType = itk::TranslationTransform<double, Dimension>;
-  auto transform = TransformType::New();
+
+  const unsigned int numberOfThreads =
+    argc > 2 ? atoi(argv[2]) : itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+  const unsigned int numberOfOffspring = argc > 3 ? atoi(argv[3]) : 1;
+  const unsigned int numberOfLevels = argc > 4 ? std::max(1, atoi(argv[4])) : 1;
+  const std::string  search = argc > 5 ? argv[5] : "evolutionary";
+  const bool         useLBFGS = search == "lbfgs";
+  const bool         useGradient = search == "gradient" || useLBFGS;
+  const bool         useInterpolator = argc > 6 && std::string(argv[6]) == "linear";
 
 
   itk::Statistics::NormalVariateGenerator::Pointer generator = itk::Statistics::NormalVariateGenerator::New();
@@ -292,23 +1450,11 @@ main(int argc, char * argv[])
 
   generator->Initialize(12345);
 
-  optimizer->SetNormalVariateGenerator(generator);
-  optimizer->Initialize(5);
-  optimizer->SetMaximumIteration(1000);
-
 
   TransformType::ParametersType parametersScale(Dimension);
 
   parametersScale.Fill(2.0);
 
-  optimizer->SetScales(parametersScale);
-
-
-  using IterationCallbackType = IterationCallback<OptimizerType>;
-
-  auto callback = IterationCallbackType::New();
-
-  callback->SetOptimizer(optimizer);
 
   using ReaderType = itk::ImageFileReader<ImageType>;
   ReaderType::Pointer reader = ReaderType::New();
@@ -335,7 +1481,7 @@ main(int argc, char * argv[])
   }
 
   ellipse->GetObjectToParentTransform()->SetOffset(offset);
-  ellipse->ComputeObjectToWorldTransform();
+  ellipse->Update();
 
 
   using RegionType = ImageType::RegionType;
@@ -358,41 +1504,114 @@ main(int argc, char * argv[])
   fixedRegion.SetSize(fixedRegionSize);
   fixedRegion.SetIndex(fixedRegionStart);
 
-  metric->SetFixedImageRegion(fixedRegion);
 
-  registration->SetFixedImage(reader->GetOutput());
-  registration->SetMovingSpatialObject(ellipse);
-  registration->SetTransform(transform);
-  registration->SetInterpolator(interpolator);
-  registration->SetOptimizer(optimizer);
-  registration->SetMetric(metric);
+  // Coarse-to-fine: the pyramid smooths and shrinks the image by two per
+  // level. Every level starts from the solution of the coarser one, with
+  // half the search radius and a quarter of the iterations; the finest
+  // level is the unsmoothed input. With one level this is the original
+  // single registration of up to 1000 iterations.
+  using PyramidType = itk::MultiResolutionPyramidImageFilter<ImageType, ImageType>;
+  auto pyramid = PyramidType::New();
+  pyramid->SetInput(reader->GetOutput());
+  pyramid->SetNumberOfLevels(numberOfLevels);
+  if (numberOfLevels > 1)
+  {
+    pyramid->Update();
+  }
 
-  TransformType::ParametersType initialParameters = transform->GetParameters();
+  // One metric per level, so each level scans its points once.
+  std::vector<MetricType::Pointer> metrics(numberOfLevels);
 
-  initialParameters.Fill(0.0);
+  TransformType::ParametersType parameters(Dimension);
 
+  parameters.Fill(0.0);
 
-  registration->SetInitialTransformParameters(initialParameters);
+  std::cout << "Initial Parameters  : " << parameters << std::endl;
 
-  std::cout << "Initial Parameters  : " << initialParameters << std::endl;
+  for (unsigned int level = 0; level < numberOfLevels; ++level)
+  {
+    const ImageType * levelImage = level + 1 < numberOfLevels ? pyramid->GetOutput(level) : reader->GetOutput();
 
-  optimizer->MaximizeOn();
+    const double       initialRadius = 5.0 / std::pow(2.0, level);
+    const unsigned int maximumIteration = static_cast<unsigned int>(std::max(1.0, 1000.0 / std::pow(4.0, level)));
 
+    metrics[level] = MetricType::New();
+    MetricType * metric = metrics[level];
+    metric->SetNumberOfWorkUnits(numberOfThreads);
+    metric->SetUseInterpolator(useInterpolator);
+    metric->SetFixedImageRegion(MapRegionToLevel(fixedRegion, reader->GetOutput(), levelImage));
 
-  try
-  {
-    registration->Update();
-  }
-  catch (const itk::ExceptionObject & exp)
-  {
-    std::cerr << "Exception caught ! " << std::endl;
-    std::cerr << exp << std::endl;
-  }
+    // With several offspring the optimizer evaluates them concurrently, one
+    // work unit each, instead of splitting every evaluation over the threads.
+    itk::SingleValuedNonLinearOptimizer::Pointer optimizer;
+    if (useGradient)
+    {
+      // The largest, or for LBFGS the first, step is the initial evolutionary
+      // search radius over the scales.
+      metric->ComputeGradientOn();
+      if (useLBFGS)
+      {
+        optimizer = CreateLBFGSOptimizer(
+          parametersScale, initialRadius / parametersScale[0], std::max(10u, maximumIteration / 10));
+      }
+      else
+      {
+        optimizer = CreateGradientOptimizer(
+          parametersScale, initialRadius / parametersScale[0], std::max(10u, maximumIteration / 10));
+      }
+    }
+    else if (numberOfOffspring > 1)
+    {
+      using OptimizerType = OnePlusLambdaEvolutionaryOptimizer;
+
+      auto populationOptimizer =
+        CreateEvolutionaryOptimizer<OptimizerType>(generator, parametersScale, initialRadius, maximumIteration);
+      populationOptimizer->SetNumberOfOffspring(numberOfOffspring);
+      populationOptimizer->SetNumberOfWorkUnits(numberOfThreads);
+      metric->SetNumberOfWorkUnits(1);
+      optimizer = populationOptimizer;
+    }
+    else
+    {
+      using OptimizerType = itk::OnePlusOneEvolutionaryOptimizer;
+
+      optimizer =
+        CreateEvolutionaryOptimizer<OptimizerType>(generator, parametersScale, initialRadius, maximumIteration);
+    }
 
+    auto registration = RegistrationType::New();
+    auto interpolator = InterpolatorType::New();
+    auto transform = TransformType::New();
+
+    registration->SetFixedImage(levelImage);
+    registration->SetMovingSpatialObject(ellipse);
+    registration->SetTransform(transform);
+    registration->SetInterpolator(interpolator);
+    registration->SetOptimizer(optimizer);
+    registration->SetMetric(metric);
+    registration->SetInitialTransformParameters(parameters);
+
+    if (numberOfLevels > 1)
+    {
+      std::cout << "Level " << level << " spacing " << levelImage->GetSpacing() << std::endl;
+    }
+
+    try
+    {
+      registration->Update();
+    }
+    catch (const itk::ExceptionObject & exp)
+    {
+      std::cerr << "Exception caught ! " << std::endl;
+      std::cerr << exp << std::endl;
+      break;
+    }
+
+    parameters = registration->GetLastTransformParameters();
+  }
 
-  RegistrationType::ParametersType finalParameters = registration->GetLastTransformParameters();
 
-  std::cout << "Final Solution is : " << finalParameters << std::endl;
+  std::cout << "Final Solution is : " << parameters << std::endl;
 
   return 0;
 }
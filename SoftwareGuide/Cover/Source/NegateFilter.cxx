@@ -20,6 +20,7 @@
 #include "itkImageFileWriter.h"
 #include "itkUnaryFunctorImageFilter.h"
 #include "itkImage.h"
+#include "itkStreamingMemoryBudget.h"
 
 namespace itk
 {
@@ -71,7 +72,7 @@ main(int argc, char ** argv)
   if (argc < 3)
   {
     std::cerr << "Usage: " << std::endl;
-    std::cerr << argv[0] << " inputImageFile  outputImageFile " << std::endl;
+    std::cerr << argv[0] << " inputImageFile  outputImageFile [memoryBudgetMB]" << std::endl;
     return -1;
   }
 
@@ -110,6 +111,12 @@ main(int argc, char ** argv)
 
   try
   {
+    reader->UpdateOutputInformation();
+
+    const double memoryBudget = (argc > 3) ? atof(argv[3]) : 0.0;
+    writer->SetNumberOfStreamDivisions(itk::ComputeNumberOfStreamDivisions(
+      reader->GetOutput()->GetLargestPossibleRegion(), 2 * sizeof(PixelType), memoryBudget));
+
     writer->Update();
   }
   catch (const itk::ExceptionObject & err)
@@ -0,0 +1,86 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    RGBToHSVFilter.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkRGBToHSVImageFilter.h"
+#include "itkImage.h"
+#include "itkRGBPixel.h"
+#include "itkVector.h"
+
+
+int
+main(int argc, char ** argv)
+{
+
+  // Verify the number of parameters in the command line
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << std::endl;
+    std::cerr << argv[0] << " inputImageFile  outputImageFile " << std::endl;
+    return -1;
+  }
+
+
+  using InputPixelType = itk::RGBPixel<float>;
+  using OutputPixelType = itk::Vector<float, 3>;
+
+  constexpr unsigned int Dimension = 3;
+
+  using InputImageType = itk::Image<InputPixelType, Dimension>;
+  using OutputImageType = itk::Image<OutputPixelType, Dimension>;
+
+
+  using ReaderType = itk::ImageFileReader<InputImageType>;
+  using WriterType = itk::ImageFileWriter<OutputImageType>;
+
+
+  using FilterType = itk::RGBToHSVImageFilter<InputImageType, OutputImageType>;
+
+  auto filter = FilterType::New();
+
+
+  auto reader = ReaderType::New();
+  auto writer = WriterType::New();
+
+  const char * inputFilename = argv[1];
+  const char * outputFilename = argv[2];
+
+  reader->SetFileName(inputFilename);
+  writer->SetFileName(outputFilename);
+
+
+  filter->SetInput(reader->GetOutput());
+
+  writer->SetInput(filter->GetOutput());
+
+
+  try
+  {
+    writer->Update();
+  }
+  catch (const itk::ExceptionObject & err)
+  {
+    std::cout << "ExceptionObject caught !" << std::endl;
+    std::cout << err << std::endl;
+    return -1;
+  }
+
+
+  return 0;
+}
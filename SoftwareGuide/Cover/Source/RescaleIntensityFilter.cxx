@@ -19,7 +19,10 @@
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 #include "itkRescaleIntensityImageFilter.h"
+#include "itkIntensityWindowingImageFilter.h"
+#include "itkStatisticsImageFilter.h"
 #include "itkImage.h"
+#include "itkStreamingMemoryBudget.h"
 
 
 int
@@ -30,7 +33,7 @@ main(int argc, char ** argv)
   if (argc < 3)
   {
     std::cerr << "Usage: " << std::endl;
-    std::cerr << argv[0] << " inputImageFile  outputImageFile " << std::endl;
+    std::cerr << argv[0] << " inputImageFile  outputImageFile [memoryBudgetMB]" << std::endl;
     return -1;
   }
 
@@ -49,6 +52,8 @@ main(int argc, char ** argv)
 
 
   using FilterType = itk::RescaleIntensityImageFilter<InputImageType, OutputImageType>;
+  using WindowingFilterType = itk::IntensityWindowingImageFilter<InputImageType, OutputImageType>;
+  using StatisticsFilterType = itk::StatisticsImageFilter<InputImageType>;
 
   auto filter = FilterType::New();
 
@@ -63,6 +68,27 @@ main(int argc, char ** argv)
   writer->SetFileName(outputFilename);
 
 
+  const double memoryBudget = (argc > 3) ? atof(argv[3]) : 0.0;
+
+  unsigned int numberOfDivisions = 1;
+
+  try
+  {
+    reader->UpdateOutputInformation();
+    numberOfDivisions = itk::ComputeNumberOfStreamDivisions(reader->GetOutput()->GetLargestPossibleRegion(),
+                                                            sizeof(InputPixelType) + sizeof(OutputPixelType),
+                                                            memoryBudget);
+  }
+  catch (const itk::ExceptionObject & err)
+  {
+    std::cout << "ExceptionObject caught !" << std::endl;
+    std::cout << err << std::endl;
+    return -1;
+  }
+
+  std::cout << "Processing in " << numberOfDivisions << " slabs" << std::endl;
+
+
   filter->SetInput(reader->GetOutput());
 
   writer->SetInput(filter->GetOutput());
@@ -70,6 +96,47 @@ main(int argc, char ** argv)
   filter->SetOutputMinimum(0);
   filter->SetOutputMaximum(255);
 
+
+  //
+  // RescaleIntensityImageFilter takes the intensity range from the region
+  // it is asked for, which would be each slab on its own. When streaming,
+  // the range of the whole volume is gathered in a first streamed pass and
+  // applied by an IntensityWindowingImageFilter, which maps it exactly as
+  // the rescaler would.
+  //
+  auto windowing = WindowingFilterType::New();
+
+  if (numberOfDivisions > 1)
+  {
+    auto statistics = StatisticsFilterType::New();
+    statistics->SetInput(reader->GetOutput());
+    statistics->SetNumberOfStreamDivisions(numberOfDivisions);
+
+    try
+    {
+      statistics->Update();
+    }
+    catch (const itk::ExceptionObject & err)
+    {
+      std::cout << "ExceptionObject caught !" << std::endl;
+      std::cout << err << std::endl;
+      return -1;
+    }
+
+    if (statistics->GetMinimum() < statistics->GetMaximum())
+    {
+      windowing->SetInput(reader->GetOutput());
+      windowing->SetWindowMinimum(statistics->GetMinimum());
+      windowing->SetWindowMaximum(statistics->GetMaximum());
+      windowing->SetOutputMinimum(0);
+      windowing->SetOutputMaximum(255);
+
+      writer->SetInput(windowing->GetOutput());
+    }
+  }
+
+  writer->SetNumberOfStreamDivisions(numberOfDivisions);
+
   try
   {
     writer->Update();
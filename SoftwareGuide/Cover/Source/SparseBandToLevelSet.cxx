@@ -0,0 +1,94 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    SparseBandToLevelSet.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+//
+// Expands a narrow band written by AntialiasFilter into the full level set,
+// taking the sign off the band from the mask it was computed from.
+//
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkSparseBandLevelSet.h"
+
+
+int
+main(int argc, char ** argv)
+{
+
+  // Verify the number of parameters in the command line
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << std::endl;
+    std::cerr << argv[0] << " inputBandFile.sbl  maskImageFile  outputImageFile " << std::endl;
+    std::cerr << " [foregroundValue] " << std::endl;
+    return -1;
+  }
+
+
+  using MaskPixelType = unsigned char;
+
+  constexpr unsigned int Dimension = 3;
+
+  using MaskImageType = itk::Image<MaskPixelType, Dimension>;
+  using BandType = itk::SparseBandLevelSet<Dimension>;
+  using LevelSetImageType = BandType::DenseImageType;
+
+  using ReaderType = itk::ImageFileReader<MaskImageType>;
+  using WriterType = itk::ImageFileWriter<LevelSetImageType>;
+
+  const MaskPixelType foreground = argc > 4 ? static_cast<MaskPixelType>(atoi(argv[4])) : 255;
+
+
+  auto band = BandType::New();
+  auto reader = ReaderType::New();
+
+  reader->SetFileName(argv[2]);
+
+  try
+  {
+    band->Read(argv[1]);
+    reader->Update();
+  }
+  catch (const itk::ExceptionObject & err)
+  {
+    std::cout << "ExceptionObject caught !" << std::endl;
+    std::cout << err << std::endl;
+    return -1;
+  }
+
+  std::cout << "Band pixels: " << band->GetNumberOfEntries() << std::endl;
+
+
+  auto writer = WriterType::New();
+
+  writer->SetFileName(argv[3]);
+
+  try
+  {
+    writer->SetInput(band->GetDenseImage(reader->GetOutput(), foreground));
+    writer->Update();
+  }
+  catch (const itk::ExceptionObject & err)
+  {
+    std::cout << "ExceptionObject caught !" << std::endl;
+    std::cout << err << std::endl;
+    return -1;
+  }
+
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    SparseHistogramToImage.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+//
+// Expands a sparse histogram written by VWHistogramRGB or VWHistogramHSV
+// into the equivalent dense 256x256x256 image.
+//
+
+#include "itkImageFileWriter.h"
+#include "itkSparseColorHistogram.h"
+
+
+int
+main(int argc, char ** argv)
+{
+
+  // Verify the number of parameters in the command line
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << std::endl;
+    std::cerr << argv[0] << " inputHistogramFile.sch  outputImageFile " << std::endl;
+    return -1;
+  }
+
+
+  using CountType = unsigned long long;
+
+  using HistogramType = itk::SparseColorHistogram<CountType>;
+  using ImageType = HistogramType::DenseImageType;
+
+  using WriterType = itk::ImageFileWriter<ImageType>;
+
+
+  auto histogram = HistogramType::New();
+
+  try
+  {
+    histogram->Read(argv[1]);
+  }
+  catch (const itk::ExceptionObject & err)
+  {
+    std::cout << "ExceptionObject caught !" << std::endl;
+    std::cout << err << std::endl;
+    return -1;
+  }
+
+  std::cout << "Non-empty bins: " << histogram->GetNumberOfEntries() << std::endl;
+
+
+  auto writer = WriterType::New();
+
+  writer->SetFileName(argv[2]);
+  writer->SetInput(histogram->GetDenseImage());
+
+
+  try
+  {
+    writer->Update();
+  }
+  catch (const itk::ExceptionObject & err)
+  {
+    std::cout << "ExceptionObject caught !" << std::endl;
+    std::cout << err << std::endl;
+    return -1;
+  }
+
+
+  return 0;
+}
@@ -2,16 +2,19 @@
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 #include "itkRGBPixel.h"
-#include "itkImageRegionIterator.h"
+#include "itkPlaneSeparationImageFilter.h"
+#include "itkStreamingMemoryBudget.h"
 
 
 int
 main(int argc, char * argv[])
 {
 
-  if (argc < 3)
+  // The plane takes all four coefficients or none.
+  if (argc < 3 || (argc > 4 && argc < 8))
   {
-    std::cerr << "VWBlueRemoval  inputFile outputFile" << std::endl;
+    std::cerr << "VWBlueRemoval  inputFile outputFile [memoryBudgetMB [A B C D]]" << std::endl;
+    std::cerr << "A memoryBudgetMB of 0 processes the whole volume at once" << std::endl;
     return -1;
   }
 
@@ -23,38 +26,42 @@ main(int argc, char * argv[])
   using ImageReaderType = itk::ImageFileReader<ImageType>;
   using ImageWriterType = itk::ImageFileWriter<ImageType>;
 
+  using FilterType = itk::PlaneSeparationImageFilter<ImageType>;
 
-  ImageType::Pointer image;
 
-  { // Local scoope for destroying the reader
-    auto imageReader = ImageReaderType::New();
-    imageReader->SetFileName(argv[1]);
-    try
-    {
-      imageReader->Update();
-    }
-    catch (const itk::ExceptionObject & excp)
-    {
-      std::cout << excp << std::endl;
-      return -1;
-    }
+  const double memoryBudget = (argc > 3) ? atof(argv[3]) : 0.0;
 
-    image = imageReader->GetOutput();
-  }
 
-  using IteratorType = itk::ImageRegionIterator<ImageType>;
+  auto imageReader = ImageReaderType::New();
+  imageReader->SetFileName(argv[1]);
 
-  IteratorType it(image, image->GetBufferedRegion());
-  it.GoToBegin();
+  try
+  {
+    imageReader->UpdateOutputInformation();
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cout << excp << std::endl;
+    return -1;
+  }
 
 
   //
   // Separatrix Plane Coefficients
   //
-  const double     A = -48.0;
-  constexpr double B = 0.0;
-  constexpr double C = 59.0;
-  constexpr double D = 106.0;
+  FilterType::PlaneType plane;
+  plane[0] = -48.0; // A
+  plane[1] = 0.0;   // B
+  plane[2] = 59.0;  // C
+  plane[3] = 106.0; // D
+
+  if (argc >= 8)
+  {
+    for (unsigned int k = 0; k < 4; ++k)
+    {
+      plane[k] = atof(argv[4 + k]);
+    }
+  }
 
 
   //
@@ -69,29 +76,25 @@ main(int argc, char * argv[])
   //
   //  In place replacement
   //
-  while (!it.IsAtEnd())
-  {
-    ImagePixelType           pixel = it.Get();
-    const PixelComponentType red = pixel.GetRed();
-    const PixelComponentType green = pixel.GetGreen();
-    const PixelComponentType blue = pixel.GetBlue();
+  auto filter = FilterType::New();
+  filter->SetInput(imageReader->GetOutput());
+  filter->SetPlane(plane);
+  filter->SetReplaceValue(replaceValue);
+  filter->InPlaceOn();
 
-    const double distanceToPlane = A * red + B * green + C * blue + D;
 
-    const bool pixelIsOnBlueSide = (distanceToPlane > 0);
+  // The filter runs in place, so only one RGB slab is alive at a time.
+  const unsigned int numberOfDivisions = itk::ComputeNumberOfStreamDivisions(
+    imageReader->GetOutput()->GetLargestPossibleRegion(), sizeof(ImagePixelType), memoryBudget);
 
-    if (pixelIsOnBlueSide)
-    {
-      it.Set(replaceValue);
-    }
-    ++it;
-  }
+  std::cout << "Processing in " << numberOfDivisions << " slabs" << std::endl;
 
 
   auto imageWriter = ImageWriterType::New();
 
   imageWriter->SetFileName(argv[2]);
-  imageWriter->SetInput(image);
+  imageWriter->SetInput(filter->GetOutput());
+  imageWriter->SetNumberOfStreamDivisions(numberOfDivisions);
 
 
   try
@@ -5,7 +5,28 @@
 #include "itkImageFileWriter.h"
 #include "itkRGBPixel.h"
 #include "itkImageRegionIterator.h"
-#include "itkVectorConfidenceConnectedImageFilter.h"
+#include "itkParallelVectorConfidenceConnectedImageFilter.h"
+#include "itkMultiLabelVectorConfidenceConnectedImageFilter.h"
+#include "VWSeedsFile.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+// Split a comma-separated argument into its items.
+std::vector<std::string>
+SplitList(const std::string & argument)
+{
+  std::vector<std::string> items;
+  std::istringstream       stream(argument);
+  std::string              item;
+  while (std::getline(stream, item, ','))
+  {
+    items.push_back(item);
+  }
+  return items;
+}
 
 
 int
@@ -14,7 +35,10 @@ main(int argc, char * argv[])
 
   if (argc < 6)
   {
-    std::cerr << "VWColorSegmentation  inputFile outputFile seedsFile multiplier numberOfIterations" << std::endl;
+    std::cerr << "VWColorSegmentation  inputFile outputFile seedsFile multiplier numberOfIterations [numberOfWorkUnits]"
+              << std::endl;
+    std::cerr << "  Comma-separated lists of seeds files and multipliers segment several tissues at once"
+              << " into a label image, tissue i getting label i." << std::endl;
     return -1;
   }
 
@@ -29,7 +53,7 @@ main(int argc, char * argv[])
   using ImageReaderType = itk::ImageFileReader<ImageType>;
   using ImageWriterType = itk::ImageFileWriter<OutputImageType>;
 
-  using ConfidenceConnectedFilterType = itk::VectorConfidenceConnectedImageFilter<ImageType, OutputImageType>;
+  using ConfidenceConnectedFilterType = itk::ParallelVectorConfidenceConnectedImageFilter<ImageType, OutputImageType>;
 
   ConfidenceConnectedFilterType::Pointer confidenceFilter = ConfidenceConnectedFilterType::New();
 
@@ -50,43 +74,74 @@ main(int argc, char * argv[])
     return -1;
   }
 
-  confidenceFilter->SetInput(imageReader->GetOutput());
+  // Several seeds files grow one tissue each, all in the same waves over
+  // the volume, with one multiplier per file or a single one for all.
+  const std::vector<std::string> seedsFilenames = SplitList(argv[3]);
+  if (seedsFilenames.size() > 1)
+  {
+    using MultiLabelFilterType = itk::MultiLabelVectorConfidenceConnectedImageFilter<ImageType, OutputImageType>;
 
+    const std::vector<std::string> multipliers = SplitList(argv[4]);
+    if (multipliers.size() != 1 && multipliers.size() != seedsFilenames.size())
+    {
+      std::cerr << "Expected one multiplier, or one per seeds file" << std::endl;
+      return -1;
+    }
 
-  confidenceFilter->SetReplaceValue(255);
-  confidenceFilter->SetNumberOfIterations(atoi(argv[5]));
-  confidenceFilter->SetMultiplier(atof(argv[4]));
+    auto multiLabelFilter = MultiLabelFilterType::New();
+    multiLabelFilter->SetInput(imageReader->GetOutput());
+    multiLabelFilter->SetNumberOfIterations(atoi(argv[5]));
+    if (argc > 6)
+    {
+      multiLabelFilter->SetNumberOfWorkUnits(atoi(argv[6]));
+    }
 
-  std::ifstream seedsFile;
-  seedsFile.open(argv[3]);
+    try
+    {
+      for (unsigned int i = 0; i < seedsFilenames.size(); ++i)
+      {
+        MultiLabelFilterType::SeedsContainerType seeds;
+        if (!ReadSeeds(seedsFilenames[i], seeds))
+        {
+          return -1;
+        }
+        multiLabelFilter->AddSeedSet(seeds, atof(multipliers[multipliers.size() > 1 ? i : 0].c_str()));
+      }
+
+      auto labelWriter = ImageWriterType::New();
+      labelWriter->SetFileName(argv[2]);
+      labelWriter->SetInput(multiLabelFilter->GetOutput());
+      labelWriter->Update();
+    }
+    catch (const itk::ExceptionObject & excp)
+    {
+      std::cerr << excp << std::endl;
+      return -1;
+    }
 
-  if (seedsFile.fail())
-  {
-    std::cerr << "Problem opening seeds file " << std::endl;
+    return 0;
   }
 
-  ImageType::IndexType index;
-
-  float x;
-  float y;
-  float z;
-
-  seedsFile >> x >> y >> z;
+  confidenceFilter->SetInput(imageReader->GetOutput());
 
-  index[0] = static_cast<signed long>(x);
-  index[1] = static_cast<signed long>(y);
-  index[2] = static_cast<signed long>(z);
 
-  while (!seedsFile.eof())
+  confidenceFilter->SetReplaceValue(255);
+  confidenceFilter->SetNumberOfIterations(atoi(argv[5]));
+  confidenceFilter->SetMultiplier(atof(argv[4]));
+  if (argc > 6)
   {
-    confidenceFilter->AddSeed(index);
-    seedsFile >> x >> y >> z;
-    index[0] = static_cast<signed long>(x);
-    index[1] = static_cast<signed long>(y);
-    index[2] = static_cast<signed long>(z);
+    confidenceFilter->SetNumberOfWorkUnits(atoi(argv[6]));
   }
 
-  seedsFile.close();
+  ConfidenceConnectedFilterType::SeedsContainerType seeds;
+  if (!ReadSeeds(argv[3], seeds))
+  {
+    return -1;
+  }
+  for (const auto & seed : seeds)
+  {
+    confidenceFilter->AddSeed(seed);
+  }
 
   try
   {
@@ -0,0 +1,467 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    VWCoverPipeline.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+//
+// Runs the cover segmentation chain
+//
+//   extract ROI -> blue removal -> colour segmentation -> median
+//               -> dilate -> antialias -> rescale
+//
+// as a single ITK pipeline. Intermediate images stay in memory and are
+// released as soon as the next stage has consumed them. The stages listed
+// under "checkpoints" in the parameter file are also written to disk, as
+// "<checkpointPrefix><stage>.mha", and kept. See
+// VWCoverPipelineParameters.txt for the parameter file format.
+//
+// The median, the dilation and the antialiasing each run only on the
+// padded bounding box of the mask, which is usually a small part of the
+// volume, and their output is pasted back into the full image.
+//
+
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkRGBPixel.h"
+#include "itkRegionOfInterestImageFilter.h"
+#include "itkPlaneSeparationImageFilter.h"
+#include "itkParallelVectorConfidenceConnectedImageFilter.h"
+#include "itkRunningSumBinaryMedianImageFilter.h"
+#include "itkFastBinaryBallDilateImageFilter.h"
+#include "itkAntiAliasBinaryImageFilter.h"
+#include "itkSmoothedSignedDistanceImageFilter.h"
+#include "itkCropToForegroundImageFilter.h"
+#include "itkRescaleIntensityImageFilter.h"
+#include "VWSeedsFile.h"
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using ParametersType = std::map<std::string, std::vector<std::string>>;
+
+
+//
+// Reads "key value [value ...]" lines. Empty lines and lines starting with
+// '#' are ignored.
+//
+bool
+ReadParameters(const char * fileName, ParametersType & parameters)
+{
+  std::ifstream file(fileName);
+  if (file.fail())
+  {
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(file, line))
+  {
+    std::istringstream words(line);
+    std::string        key;
+    if (!(words >> key) || key[0] == '#')
+    {
+      continue;
+    }
+    std::vector<std::string> & values = parameters[key];
+    values.clear();
+    std::string value;
+    while (words >> value)
+    {
+      values.push_back(value);
+    }
+  }
+  return true;
+}
+
+
+const std::string &
+GetParameter(const ParametersType & parameters, const std::string & key, unsigned int position = 0)
+{
+  static const std::string empty;
+  const auto               it = parameters.find(key);
+  if (it == parameters.end() || it->second.size() <= position)
+  {
+    return empty;
+  }
+  return it->second[position];
+}
+
+
+//
+// Updates the upstream pipeline and writes a stage output when that stage
+// is listed as a checkpoint. The written data stays cached in the pipeline,
+// so the final update does not recompute it.
+//
+template <typename TImage>
+int
+WriteCheckpoint(TImage *                      image,
+                const std::string &           stage,
+                const std::set<std::string> & checkpoints,
+                const std::string &           prefix)
+{
+  if (checkpoints.find(stage) == checkpoints.end())
+  {
+    return 0;
+  }
+
+  using WriterType = itk::ImageFileWriter<TImage>;
+  auto writer = WriterType::New();
+  writer->SetFileName(prefix + stage + ".mha");
+  writer->SetInput(image);
+
+  std::cout << "Writing checkpoint " << writer->GetFileName() << std::endl;
+
+  try
+  {
+    writer->Update();
+  }
+  catch (const itk::ExceptionObject & err)
+  {
+    std::cout << "ExceptionObject caught !" << std::endl;
+    std::cout << err << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+
+int
+main(int argc, char ** argv)
+{
+
+  // Verify the number of parameters in the command line
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << std::endl;
+    std::cerr << argv[0] << " parameterFile " << std::endl;
+    return -1;
+  }
+
+  ParametersType parameters;
+  if (!ReadParameters(argv[1], parameters))
+  {
+    std::cerr << "Problem opening parameter file " << argv[1] << std::endl;
+    return -1;
+  }
+
+  const std::string inputFilename = GetParameter(parameters, "input");
+  const std::string outputFilename = GetParameter(parameters, "output");
+  const std::string seedsFilename = GetParameter(parameters, "seeds");
+  const std::string multiplier = GetParameter(parameters, "multiplier");
+  const std::string iterations = GetParameter(parameters, "iterations");
+
+  if (inputFilename.empty() || outputFilename.empty() || seedsFilename.empty() || multiplier.empty() ||
+      iterations.empty())
+  {
+    std::cerr << "The parameters input, output, seeds, multiplier and iterations are required" << std::endl;
+    return -1;
+  }
+
+  std::set<std::string> checkpoints;
+  if (parameters.count("checkpoints"))
+  {
+    checkpoints.insert(parameters["checkpoints"].begin(), parameters["checkpoints"].end());
+  }
+  const std::string checkpointPrefix = GetParameter(parameters, "checkpointPrefix");
+
+
+  using PixelComponentType = unsigned char;
+  using RGBPixelType = itk::RGBPixel<PixelComponentType>;
+  using MaskPixelType = unsigned char;
+  using LevelSetPixelType = float;
+
+  constexpr unsigned int Dimension = 3;
+
+  using RGBImageType = itk::Image<RGBPixelType, Dimension>;
+  using MaskImageType = itk::Image<MaskPixelType, Dimension>;
+  using LevelSetImageType = itk::Image<LevelSetPixelType, Dimension>;
+
+
+  //
+  // Extract ROI
+  //
+  using ReaderType = itk::ImageFileReader<RGBImageType>;
+  using ROIFilterType = itk::RegionOfInterestImageFilter<RGBImageType, RGBImageType>;
+
+  auto reader = ReaderType::New();
+  reader->SetFileName(inputFilename);
+
+  RGBImageType * rgbImage = reader->GetOutput();
+
+  auto roiFilter = ROIFilterType::New();
+  if (parameters.count("roi"))
+  {
+    if (parameters["roi"].size() != 2 * Dimension)
+    {
+      std::cerr << "The parameter roi takes " << 2 * Dimension << " values: startX startY startZ sizeX sizeY sizeZ"
+                << std::endl;
+      return -1;
+    }
+
+    RGBImageType::IndexType start;
+    RGBImageType::SizeType  size;
+    for (unsigned int i = 0; i < Dimension; ++i)
+    {
+      start[i] = atoi(GetParameter(parameters, "roi", i).c_str());
+      size[i] = atoi(GetParameter(parameters, "roi", Dimension + i).c_str());
+    }
+
+    RGBImageType::RegionType wantedRegion;
+    wantedRegion.SetSize(size);
+    wantedRegion.SetIndex(start);
+
+    roiFilter->SetRegionOfInterest(wantedRegion);
+    roiFilter->SetInput(rgbImage);
+    roiFilter->SetReleaseDataFlag(!checkpoints.count("roi"));
+    rgbImage = roiFilter->GetOutput();
+
+    if (WriteCheckpoint(rgbImage, "roi", checkpoints, checkpointPrefix))
+    {
+      return -1;
+    }
+  }
+
+
+  //
+  // Blue removal, in place on the extracted region
+  //
+  using BlueRemovalFilterType = itk::PlaneSeparationImageFilter<RGBImageType>;
+
+  auto blueRemoval = BlueRemovalFilterType::New();
+  if (GetParameter(parameters, "blueRemoval") != "off")
+  {
+    BlueRemovalFilterType::PlaneType plane;
+    plane[0] = -48.0;
+    plane[1] = 0.0;
+    plane[2] = 59.0;
+    plane[3] = 106.0;
+    if (parameters.count("blueRemoval"))
+    {
+      if (parameters["blueRemoval"].size() != 4)
+      {
+        std::cerr << "The parameter blueRemoval takes off or the 4 plane coefficients A B C D" << std::endl;
+        return -1;
+      }
+      for (unsigned int k = 0; k < 4; ++k)
+      {
+        plane[k] = atof(GetParameter(parameters, "blueRemoval", k).c_str());
+      }
+    }
+
+    blueRemoval->SetPlane(plane);
+    blueRemoval->SetReplaceValue(itk::NumericTraits<RGBPixelType>::ZeroValue());
+    blueRemoval->InPlaceOn();
+    blueRemoval->SetInput(rgbImage);
+    rgbImage = blueRemoval->GetOutput();
+
+    if (WriteCheckpoint(rgbImage, "blueRemoval", checkpoints, checkpointPrefix))
+    {
+      return -1;
+    }
+  }
+
+
+  //
+  // Colour segmentation
+  //
+  using ConfidenceConnectedFilterType = itk::ParallelVectorConfidenceConnectedImageFilter<RGBImageType, MaskImageType>;
+
+  auto confidenceFilter = ConfidenceConnectedFilterType::New();
+  confidenceFilter->SetInput(rgbImage);
+  confidenceFilter->SetReleaseDataFlag(!checkpoints.count("segmentation"));
+  confidenceFilter->SetReplaceValue(255);
+  confidenceFilter->SetNumberOfIterations(atoi(iterations.c_str()));
+  confidenceFilter->SetMultiplier(atof(multiplier.c_str()));
+
+  ConfidenceConnectedFilterType::SeedsContainerType seeds;
+  if (!ReadSeeds(seedsFilename, seeds))
+  {
+    return -1;
+  }
+  for (const auto & seed : seeds)
+  {
+    confidenceFilter->AddSeed(seed);
+  }
+
+  MaskImageType * maskImage = confidenceFilter->GetOutput();
+
+  if (WriteCheckpoint(maskImage, "segmentation", checkpoints, checkpointPrefix))
+  {
+    return -1;
+  }
+
+
+  //
+  // Median, skipped for a radius of zero
+  //
+  using MedianFilterType = itk::RunningSumBinaryMedianImageFilter<MaskImageType, MaskImageType>;
+  using MaskCropFilterType = itk::CropToForegroundImageFilter<MaskImageType, MaskImageType>;
+
+  auto               medianFilter = MedianFilterType::New();
+  auto               medianCropFilter = MaskCropFilterType::New();
+  const unsigned int medianRadius = atoi(GetParameter(parameters, "medianRadius").c_str());
+  if (medianRadius > 0)
+  {
+    MaskImageType::SizeType radius;
+    radius.Fill(medianRadius);
+
+    medianFilter->SetRadius(radius);
+    medianFilter->SetBackgroundValue(0);
+    medianFilter->SetForegroundValue(255);
+
+    medianCropFilter->SetFilter(medianFilter);
+    medianCropFilter->SetForegroundValue(255);
+    medianCropFilter->SetInput(maskImage);
+    medianCropFilter->SetReleaseDataFlag(!checkpoints.count("median"));
+    maskImage = medianCropFilter->GetOutput();
+
+    if (WriteCheckpoint(maskImage, "median", checkpoints, checkpointPrefix))
+    {
+      return -1;
+    }
+  }
+
+
+  //
+  // Dilation, skipped for a radius of zero
+  //
+  using DilateFilterType = itk::FastBinaryBallDilateImageFilter<MaskImageType, MaskImageType>;
+
+  auto               dilateFilter = DilateFilterType::New();
+  auto               dilateCropFilter = MaskCropFilterType::New();
+  const unsigned int dilateRadius = atoi(GetParameter(parameters, "dilateRadius").c_str());
+  if (dilateRadius > 0)
+  {
+    dilateFilter->SetRadius(dilateRadius);
+    dilateFilter->SetForegroundValue(255);
+
+    MaskImageType::SizeType padding;
+    padding.Fill(dilateRadius);
+
+    dilateCropFilter->SetFilter(dilateFilter);
+    dilateCropFilter->SetForegroundValue(255);
+    dilateCropFilter->SetPadding(padding);
+    dilateCropFilter->CopyInputOutsideOn();
+    dilateCropFilter->SetInput(maskImage);
+    dilateCropFilter->SetReleaseDataFlag(!checkpoints.count("dilate"));
+    maskImage = dilateCropFilter->GetOutput();
+
+    if (WriteCheckpoint(maskImage, "dilate", checkpoints, checkpointPrefix))
+    {
+      return -1;
+    }
+  }
+
+
+  //
+  // Antialias and rescale, skipped for zero antialias iterations unless the
+  // smoothed distance replaces the antialiasing
+  //
+  using AntialiasFilterType = itk::AntiAliasBinaryImageFilter<MaskImageType, LevelSetImageType>;
+  using DistanceFilterType = itk::SmoothedSignedDistanceImageFilter<MaskImageType, LevelSetImageType>;
+  using AntialiasCropFilterType = itk::CropToForegroundImageFilter<MaskImageType, LevelSetImageType>;
+  using RescaleFilterType = itk::RescaleIntensityImageFilter<LevelSetImageType, MaskImageType>;
+
+  auto antialiasFilter = AntialiasFilterType::New();
+  auto distanceFilter = DistanceFilterType::New();
+  auto antialiasCropFilter = AntialiasCropFilterType::New();
+  auto rescaleFilter = RescaleFilterType::New();
+
+  const std::string & distanceSigma = GetParameter(parameters, "antialiasDistance", 0);
+  const unsigned int  antialiasIterations = atoi(GetParameter(parameters, "antialias", 1).c_str());
+  if (!distanceSigma.empty() || antialiasIterations > 0)
+  {
+    MaskImageType::SizeType padding;
+    if (!distanceSigma.empty())
+    {
+      const std::string & maximumDistance = GetParameter(parameters, "antialiasDistance", 1);
+      distanceFilter->SetSigma(atof(distanceSigma.c_str()));
+      distanceFilter->SetMaximumDistance(maximumDistance.empty() ? 4.0 * distanceFilter->GetSigma()
+                                                                 : atof(maximumDistance.c_str()));
+
+      // Past its reach the output is the clamped background distance.
+      try
+      {
+        maskImage->UpdateOutputInformation();
+      }
+      catch (const itk::ExceptionObject & err)
+      {
+        std::cout << "ExceptionObject caught !" << std::endl;
+        std::cout << err << std::endl;
+        return -1;
+      }
+      padding = distanceFilter->GetReach(maskImage->GetSpacing());
+      for (unsigned int d = 0; d < Dimension; ++d)
+      {
+        ++padding[d];
+      }
+
+      antialiasCropFilter->SetFilter(distanceFilter);
+    }
+    else
+    {
+      antialiasFilter->SetMaximumRMSError(atof(GetParameter(parameters, "antialias", 0).c_str()));
+      antialiasFilter->SetMaximumIterations(antialiasIterations);
+
+      // Past its sparse field layers the level set is constant.
+      padding.Fill(antialiasFilter->GetNumberOfLayers() + 2);
+
+      antialiasCropFilter->SetFilter(antialiasFilter);
+    }
+
+    antialiasCropFilter->SetForegroundValue(255);
+    antialiasCropFilter->SetPadding(padding);
+    antialiasCropFilter->SetInput(maskImage);
+    antialiasCropFilter->SetReleaseDataFlag(!checkpoints.count("antialias"));
+
+    if (WriteCheckpoint(antialiasCropFilter->GetOutput(), "antialias", checkpoints, checkpointPrefix))
+    {
+      return -1;
+    }
+
+    rescaleFilter->SetInput(antialiasCropFilter->GetOutput());
+    rescaleFilter->SetOutputMinimum(0);
+    rescaleFilter->SetOutputMaximum(255);
+    maskImage = rescaleFilter->GetOutput();
+  }
+
+
+  using WriterType = itk::ImageFileWriter<MaskImageType>;
+
+  auto writer = WriterType::New();
+  writer->SetFileName(outputFilename);
+  writer->SetInput(maskImage);
+
+
+  try
+  {
+    writer->Update();
+  }
+  catch (const itk::ExceptionObject & err)
+  {
+    std::cout << "ExceptionObject caught !" << std::endl;
+    std::cout << err << std::endl;
+    return -1;
+  }
+
+
+  return 0;
+}
@@ -2,57 +2,9 @@
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 #include "itkRGBPixel.h"
-#include "itkImageRegionConstIterator.h"
-
-
-//
-// Taken from VTK : Imaging/vtkImageRGBToHSV
-//
-void
-ConvertRGBToHSV(float R, float G, float B, float & H, float & S, float & V)
-{
-
-  constexpr float max = 255.0;
-
-  // Saturation
-  float temp = R;
-  if (G < temp)
-  {
-    temp = G;
-  }
-  if (B < temp)
-  {
-    temp = B;
-  }
-  float sumRGB = R + G + B;
-  if (sumRGB == 0.0)
-  {
-    S = 0.0;
-  }
-  else
-  {
-    S = max * (1.0 - (3.0 * temp / sumRGB));
-  }
-
-  temp = (float)(R + G + B);
-  // Value is easy
-  V = temp / 3.0;
-
-  // Hue
-  temp = sqrt((R - G) * (R - G) + (R - B) * (G - B));
-  if (temp != 0.0)
-  {
-    temp = acos((0.5 * ((R - G) + (R - B))) / temp);
-  }
-  if (G >= B)
-  {
-    H = max * (temp / 6.2831853);
-  }
-  else
-  {
-    H = max * (1.0 - (temp / 6.2831853));
-  }
-}
+#include "itkRGBHistogramCalculator.h"
+#include "itkRGBToHSVLookupTable.h"
+#include "itkSparseColorHistogram.h"
 
 
 int
@@ -61,23 +13,27 @@ main(int argc, char * argv[])
 
   if (argc < 3)
   {
-    std::cerr << "VWSegmentation  inputFile histogramHSVFile" << std::endl;
+    std::cerr << "VWSegmentation  inputFile histogramHSVFile [numberOfThreads]" << std::endl;
+    std::cerr << "A histogramHSVFile ending in .sch is written as a sparse histogram" << std::endl;
     return -1;
   }
 
+  // Zero selects the ITK global default number of threads.
+  const unsigned int numberOfThreads = (argc > 3) ? atoi(argv[3]) : 0;
+
   using PixelComponentType = unsigned char;
   using InputPixelType = itk::RGBPixel<PixelComponentType>;
   using OutputPixelType = unsigned short;
 
   using InputImageType = itk::Image<InputPixelType, 3>;
-  using OutputImageType = itk::Image<OutputPixelType, 3>;
+  using HistogramType = itk::SparseColorHistogram<OutputPixelType>;
+  using OutputImageType = HistogramType::DenseImageType;
 
   using ReaderType = itk::ImageFileReader<InputImageType>;
   using WriterType = itk::ImageFileWriter<OutputImageType>;
 
-  using RegionType = OutputImageType::RegionType;
-  using SizeType = OutputImageType::SizeType;
-  using IndexType = OutputImageType::IndexType;
+  using ColorCalculatorType = itk::RGBHistogramCalculator<InputImageType, itk::SizeValueType>;
+  using ColorHistogramType = ColorCalculatorType::SparseHistogramType;
 
   InputImageType::Pointer inputImage;
 
@@ -97,65 +53,63 @@ main(int argc, char * argv[])
     inputImage = reader->GetOutput();
   }
 
-  RegionType region;
-  SizeType   size;
-  IndexType  start;
-
-  start.Fill(0);
-
-  size[0] = 256;
-  size[1] = 256;
-  size[2] = 256;
-
-  region.SetSize(size);
-  region.SetIndex(start);
-
-  auto histogramImage = OutputImageType::New();
-  histogramImage->SetRegions(region);
-  histogramImage->Allocate();
-  histogramImage->FillBuffer(0);
-
+  //
+  // The only pass over the volume collects its distinct colours. The HSV
+  // maxima and the HSV bins are then derived from the colours, each one
+  // converted once through the lookup table.
+  //
+  std::cout << "Collecting the distinct RGB colours " << std::endl;
+
+  auto colorCalculator = ColorCalculatorType::New();
+  colorCalculator->SetImage(inputImage);
+  colorCalculator->UseSparseBinsOn();
+  if (numberOfThreads > 0)
+  {
+    colorCalculator->SetNumberOfWorkUnits(numberOfThreads);
+  }
 
-  using IteratorType = itk::ImageRegionConstIterator<InputImageType>;
+  try
+  {
+    colorCalculator->Compute();
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cout << excp << std::endl;
+    return -1;
+  }
 
-  IndexType index;
+  const ColorHistogramType::EntryContainerType & colors = colorCalculator->GetSparseHistogram()->GetEntries();
 
-  IteratorType it(inputImage, inputImage->GetBufferedRegion());
+  std::cout << "Distinct colours: " << colors.size() << std::endl;
 
-  std::cout << "Starting first pass for computing max HSV values " << std::endl;
-  it.GoToBegin();
+  const itk::Functor::RGBToHSVLookupTable & lookupTable = itk::Functor::RGBToHSVLookupTable::GetInstance();
 
-  float hue;
-  float saturation;
-  float value;
+  std::vector<float> hues(colors.size());
+  std::vector<float> saturations(colors.size());
+  std::vector<float> values(colors.size());
 
   float hueMax = 0;
   float saturationMax = 0;
   float valueMax = 0;
 
-  while (!it.IsAtEnd())
+  for (std::size_t c = 0; c < colors.size(); ++c)
   {
-    InputPixelType     pixel = it.Get();
-    PixelComponentType red = pixel.GetRed();
-    PixelComponentType green = pixel.GetGreen();
-    PixelComponentType blue = pixel.GetBlue();
+    const ColorHistogramType::IndexType color = ColorHistogramType::UnpackKey(colors[c].first);
 
-    ConvertRGBToHSV(red, green, blue, hue, saturation, value);
+    lookupTable.Evaluate(color[0], color[1], color[2], hues[c], saturations[c], values[c]);
 
-    if (hue > hueMax)
+    if (hues[c] > hueMax)
     {
-      hueMax = hue;
+      hueMax = hues[c];
     }
-    if (saturation > saturationMax)
+    if (saturations[c] > saturationMax)
     {
-      saturationMax = saturation;
+      saturationMax = saturations[c];
     }
-    if (value > valueMax)
+    if (values[c] > valueMax)
     {
-      valueMax = value;
+      valueMax = values[c];
     }
-
-    ++it;
   }
 
 
@@ -165,33 +119,42 @@ main(int argc, char * argv[])
   std::cout << "V: " << valueMax << std::endl;
 
 
-  it.GoToBegin();
+  // Only the occupied HSV bins are stored. Adding a colour count in one go
+  // wraps around exactly like incrementing the 16 bit bin voxel by voxel.
+  HistogramType::MapType counts;
 
-  while (!it.IsAtEnd())
+  for (std::size_t c = 0; c < colors.size(); ++c)
   {
-    InputPixelType     pixel = it.Get();
-    PixelComponentType red = pixel.GetRed();
-    PixelComponentType green = pixel.GetGreen();
-    PixelComponentType blue = pixel.GetBlue();
+    const HistogramType::KeyType key = HistogramType::PackIndex(static_cast<int>(255.0 * hues[c] / hueMax),
+                                                                static_cast<int>(255.0 * saturations[c] / saturationMax),
+                                                                static_cast<int>(255.0 * values[c] / valueMax));
+    counts[key] += static_cast<OutputPixelType>(colors[c].second);
+  }
 
-    ConvertRGBToHSV(red, green, blue, hue, saturation, value);
+  auto histogram = HistogramType::New();
+  histogram->Insert(counts);
 
-    index[0] = static_cast<int>(255.0 * hue / hueMax);
-    index[1] = static_cast<int>(255.0 * saturation / saturationMax);
-    index[2] = static_cast<int>(255.0 * value / valueMax);
+  std::cout << "End of HSV histogram computation" << std::endl;
+  std::cout << "Occupied bins: " << histogram->GetNumberOfEntries() << std::endl;
 
-    OutputPixelType count = histogramImage->GetPixel(index);
-    count++;
-    histogramImage->SetPixel(index, count);
-    ++it;
+  if (HistogramType::IsSparseFileName(argv[2]))
+  {
+    try
+    {
+      histogram->Write(argv[2]);
+    }
+    catch (const itk::ExceptionObject & excp)
+    {
+      std::cout << excp << std::endl;
+      return -1;
+    }
+    return 0;
   }
 
-  std::cout << "End of HSV histogram computation" << std::endl;
-
   auto writer = WriterType::New();
 
   writer->SetFileName(argv[2]);
-  writer->SetInput(histogramImage);
+  writer->SetInput(histogram->GetDenseImage());
 
 
   try
@@ -2,110 +2,130 @@
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 #include "itkRGBPixel.h"
-#include "itkImageRegionConstIterator.h"
+#include "itkRGBHistogramCalculator.h"
 
 
-int
-main(int argc, char * argv[])
-{
-
-  if (argc < 3)
-  {
-    std::cerr << "VWSegmentation  inputFile histogramRGBFile" << std::endl;
-    return -1;
-  }
+using PixelComponentType = unsigned char;
+using InputPixelType = itk::RGBPixel<PixelComponentType>;
+using InputImageType = itk::Image<InputPixelType, 3>;
 
-  using PixelComponentType = unsigned char;
-  using InputPixelType = itk::RGBPixel<PixelComponentType>;
-  using OutputPixelType = unsigned short;
 
-  using InputImageType = itk::Image<InputPixelType, 3>;
-  using OutputImageType = itk::Image<OutputPixelType, 3>;
-
-  using ReaderType = itk::ImageFileReader<InputImageType>;
+//
+// Counts the colours of the input with the requested bin width and writes
+// the 256x256x256 histogram image, or the sparse histogram when the file
+// name has the ".sch" extension.
+//
+template <typename TCount>
+int
+ComputeHistogram(const InputImageType * inputImage, const char * histogramFileName, unsigned int numberOfThreads)
+{
+  using CalculatorType = itk::RGBHistogramCalculator<InputImageType, TCount>;
+  using OutputImageType = typename CalculatorType::HistogramImageType;
   using WriterType = itk::ImageFileWriter<OutputImageType>;
 
-  using RegionType = OutputImageType::RegionType;
-  using SizeType = OutputImageType::SizeType;
-  using IndexType = OutputImageType::IndexType;
+  const bool writeSparse = CalculatorType::SparseHistogramType::IsSparseFileName(histogramFileName);
 
-  InputImageType::Pointer inputImage;
+  auto calculator = CalculatorType::New();
+  calculator->SetImage(inputImage);
+  calculator->SetUseSparseBins(writeSparse);
+  if (numberOfThreads > 0)
+  {
+    calculator->SetNumberOfWorkUnits(numberOfThreads);
+  }
 
-  { // local scope for destroying the reader
+  try
+  {
+    calculator->Compute();
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cout << excp << std::endl;
+    return -1;
+  }
 
-    auto reader = ReaderType::New();
-    reader->SetFileName(argv[1]);
+  if (writeSparse)
+  {
+    std::cout << "Distinct colours: " << calculator->GetSparseHistogram()->GetNumberOfEntries() << std::endl;
     try
     {
-      reader->Update();
+      calculator->GetSparseHistogram()->Write(histogramFileName);
     }
     catch (const itk::ExceptionObject & excp)
     {
       std::cout << excp << std::endl;
       return -1;
     }
-    inputImage = reader->GetOutput();
+    return 0;
   }
 
-  RegionType region;
-  SizeType   size;
-  IndexType  start;
-
-  start.Fill(0);
-
-  size[0] = 256;
-  size[1] = 256;
-  size[2] = 256;
+  auto writer = WriterType::New();
 
-  region.SetSize(size);
-  region.SetIndex(start);
+  writer->SetFileName(histogramFileName);
+  writer->SetInput(calculator->GetHistogramImage());
 
-  auto histogramImage = OutputImageType::New();
-  histogramImage->SetRegions(region);
-  histogramImage->Allocate();
-  histogramImage->FillBuffer(0);
 
+  try
+  {
+    writer->Update();
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cout << excp << std::endl;
+    return -1;
+  }
 
-  using IteratorType = itk::ImageRegionConstIterator<InputImageType>;
+  return 0;
+}
 
-  IteratorType it(inputImage, inputImage->GetBufferedRegion());
-  it.GoToBegin();
 
-  IndexType index;
+int
+main(int argc, char * argv[])
+{
 
-  while (!it.IsAtEnd())
+  if (argc < 3)
   {
-    InputPixelType     pixel = it.Get();
-    PixelComponentType red = pixel.GetRed();
-    PixelComponentType green = pixel.GetGreen();
-    PixelComponentType blue = pixel.GetBlue();
-    index[0] = red;
-    index[1] = green;
-    index[2] = blue;
-
-    OutputPixelType count = histogramImage->GetPixel(index);
-    count++;
-    histogramImage->SetPixel(index, count);
-    ++it;
+    std::cerr << "VWSegmentation  inputFile histogramRGBFile [countBits(16|32|64)] [numberOfThreads]" << std::endl;
+    std::cerr << "A histogramRGBFile ending in .sch is written as a sparse histogram" << std::endl;
+    return -1;
   }
 
+  // 16 bit counts keep the original output format, they wrap around on
+  // colours with more than 65535 voxels.
+  const unsigned int countBits = (argc > 3) ? atoi(argv[3]) : 16;
 
-  auto writer = WriterType::New();
+  // Zero selects the ITK global default number of threads.
+  const unsigned int numberOfThreads = (argc > 4) ? atoi(argv[4]) : 0;
 
-  writer->SetFileName(argv[2]);
-  writer->SetInput(histogramImage);
+  using ReaderType = itk::ImageFileReader<InputImageType>;
 
+  InputImageType::Pointer inputImage;
 
-  try
-  {
-    writer->Update();
+  { // local scope for destroying the reader
+
+    auto reader = ReaderType::New();
+    reader->SetFileName(argv[1]);
+    try
+    {
+      reader->Update();
+    }
+    catch (const itk::ExceptionObject & excp)
+    {
+      std::cout << excp << std::endl;
+      return -1;
+    }
+    inputImage = reader->GetOutput();
   }
-  catch (const itk::ExceptionObject & excp)
+
+  switch (countBits)
   {
-    std::cout << excp << std::endl;
-    return -1;
+    case 16:
+      return ComputeHistogram<unsigned short>(inputImage, argv[2], numberOfThreads);
+    case 32:
+      return ComputeHistogram<unsigned int>(inputImage, argv[2], numberOfThreads);
+    case 64:
+      return ComputeHistogram<unsigned long long>(inputImage, argv[2], numberOfThreads);
+    default:
+      std::cerr << "countBits must be 16, 32 or 64" << std::endl;
+      return -1;
   }
-
-
-  return 0;
 }
@@ -0,0 +1,65 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    VWSeedsFile.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef VWSeedsFile_h
+#define VWSeedsFile_h
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+// Read the seed points of a file holding one "x y z" triplet per line,
+// appending them to seeds. Reading stops at the end of the file or at the
+// first line that is not a triplet of numbers, which is reported.
+template <typename TSeedsContainer>
+bool
+ReadSeeds(const std::string & filename, TSeedsContainer & seeds)
+{
+  std::ifstream seedsFile;
+  seedsFile.open(filename);
+
+  if (seedsFile.fail())
+  {
+    std::cerr << "Problem opening seeds file " << filename << std::endl;
+    return false;
+  }
+
+  typename TSeedsContainer::value_type index;
+
+  float x;
+  float y;
+  float z;
+
+  while (seedsFile >> x >> y >> z)
+  {
+    index[0] = static_cast<signed long>(x);
+    index[1] = static_cast<signed long>(y);
+    index[2] = static_cast<signed long>(z);
+    seeds.push_back(index);
+  }
+
+  if (!seedsFile.eof())
+  {
+    std::cerr << "Seeds file " << filename << " holds a line that is not a point, the seeds after it are ignored"
+              << std::endl;
+  }
+
+  seedsFile.close();
+  return true;
+}
+
+#endif
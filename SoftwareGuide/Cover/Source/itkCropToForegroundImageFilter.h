@@ -0,0 +1,131 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkCropToForegroundImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkCropToForegroundImageFilter_h
+#define itkCropToForegroundImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+namespace itk
+{
+
+/** \class CropToForegroundImageFilter
+ * \brief Runs a filter on the padded bounding box of the foreground only.
+ *
+ * The bounding box of the pixels equal to ForegroundValue is computed in
+ * parallel with ComputeForegroundBoundingBox, padded by Padding and
+ * cropped to the image. The input is copied out on that box, with its
+ * index, origin, spacing and direction unchanged, and Filter is run on the
+ * copy. Its output is pasted back into an output that has the metadata of
+ * the input.
+ *
+ * The pixels outside the box take the value of the nearest pixel of the
+ * box, which is what a filter gives far from the foreground when Padding
+ * keeps the box edges out of its reach: BinaryMedianImageFilter with a
+ * padding of one, and AntiAliasBinaryImageFilter with a padding of two
+ * more than its number of layers. With CopyInputOutside on they keep their
+ * input value instead, as BinaryDilateImageFilter does with a padding of
+ * its radius.
+ *
+ * When there is no foreground, or the padded box covers the image, the
+ * filter runs on the whole input.
+ */
+template <typename TInputImage, typename TOutputImage = TInputImage>
+class ITK_TEMPLATE_EXPORT CropToForegroundImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(CropToForegroundImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = CropToForegroundImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(CropToForegroundImageFilter);
+
+  using InputImageType = TInputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+  using InputImageRegionType = typename InputImageType::RegionType;
+  using InputSizeType = typename InputImageType::SizeType;
+
+  using OutputImageType = TOutputImage;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  using FilterType = ImageToImageFilter<InputImageType, OutputImageType>;
+
+  /** Filter run on the box. */
+  itkSetObjectMacro(Filter, FilterType);
+  itkGetModifiableObjectMacro(Filter, FilterType);
+
+  itkSetMacro(ForegroundValue, InputPixelType);
+  itkGetConstMacro(ForegroundValue, InputPixelType);
+
+  /** Pixels added around the foreground along every dimension. */
+  itkSetMacro(Padding, InputSizeType);
+  itkGetConstReferenceMacro(Padding, InputSizeType);
+
+  /** Keep the input value outside the box rather than extending the box. */
+  itkSetMacro(CopyInputOutside, bool);
+  itkGetConstMacro(CopyInputOutside, bool);
+  itkBooleanMacro(CopyInputOutside);
+
+  /** Region the filter was run on by the last update. */
+  itkGetConstReferenceMacro(BoundingBox, InputImageRegionType);
+
+protected:
+  CropToForegroundImageFilter();
+  ~CropToForegroundImageFilter() override = default;
+
+  /** The foreground can be anywhere in the image. */
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** Paste the output of the filter into the box of the output and fill
+   * the rest of it. */
+  void
+  PasteBox(const OutputImageType * boxOutput);
+
+  typename FilterType::Pointer m_Filter;
+
+  InputPixelType       m_ForegroundValue{};
+  InputSizeType        m_Padding{};
+  bool                 m_CopyInputOutside{ false };
+  InputImageRegionType m_BoundingBox;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkCropToForegroundImageFilter.hxx"
+#endif
+
+#endif
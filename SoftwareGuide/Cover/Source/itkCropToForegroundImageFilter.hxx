@@ -0,0 +1,192 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkCropToForegroundImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkCropToForegroundImageFilter_hxx
+#define itkCropToForegroundImageFilter_hxx
+
+#include "itkForegroundBoundingBox.h"
+#include "itkImageAlgorithm.h"
+#include "itkImageScanlineIterator.h"
+#include "itkMultiThreaderBase.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+CropToForegroundImageFilter<TInputImage, TOutputImage>::CropToForegroundImageFilter()
+{
+  m_ForegroundValue = NumericTraits<InputPixelType>::max();
+  m_Padding.Fill(1);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CropToForegroundImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  if (this->GetInput())
+  {
+    auto * input = const_cast<InputImageType *>(this->GetInput());
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CropToForegroundImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CropToForegroundImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  if (!m_Filter)
+  {
+    itkExceptionMacro(<< "No filter to run on the foreground");
+  }
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+
+  this->GetMultiThreader()->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  const InputImageRegionType largest = input->GetLargestPossibleRegion();
+
+  m_BoundingBox = ComputeForegroundBoundingBox(input, m_ForegroundValue, this->GetMultiThreader());
+  const bool foundForeground = m_BoundingBox.GetNumberOfPixels() > 0;
+  m_BoundingBox.PadByRadius(m_Padding);
+  if (!foundForeground || !m_BoundingBox.Crop(largest) || m_BoundingBox == largest)
+  {
+    itkDebugMacro(<< "Running on the whole image");
+    m_BoundingBox = largest;
+
+    // A graft, so that the filter does not update the pipeline upstream.
+    auto whole = InputImageType::New();
+    whole->Graft(input);
+    m_Filter->SetInput(whole);
+    m_Filter->GraftOutput(output);
+    m_Filter->Update();
+    this->GraftOutput(m_Filter->GetOutput());
+    return;
+  }
+
+  itkDebugMacro(<< "Running on " << m_BoundingBox);
+
+  auto boxInput = InputImageType::New();
+  boxInput->CopyInformation(input);
+  boxInput->SetRegions(m_BoundingBox);
+  boxInput->Allocate();
+  ImageAlgorithm::Copy(input, boxInput.GetPointer(), m_BoundingBox, m_BoundingBox);
+
+  m_Filter->SetInput(boxInput);
+  m_Filter->UpdateLargestPossibleRegion();
+
+  output->SetBufferedRegion(output->GetRequestedRegion());
+  output->Allocate();
+  this->PasteBox(m_Filter->GetOutput());
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CropToForegroundImageFilter<TInputImage, TOutputImage>::PasteBox(const OutputImageType * boxOutput)
+{
+  constexpr unsigned int SlowDimension = OutputImageType::ImageDimension - 1;
+
+  const InputImageType *      input = this->GetInput();
+  OutputImageType *           output = this->GetOutput();
+  const OutputImageRegionType region = output->GetBufferedRegion();
+  const OutputPixelType *     boxBuffer = boxOutput->GetBufferPointer();
+  const InputPixelType *      inputBuffer = input->GetBufferPointer();
+
+  using IndexType = typename OutputImageType::IndexType;
+  IndexType lower = m_BoundingBox.GetIndex();
+  IndexType upper;
+  for (unsigned int d = 0; d <= SlowDimension; ++d)
+  {
+    upper[d] = lower[d] + static_cast<IndexValueType>(m_BoundingBox.GetSize(d)) - 1;
+  }
+
+  this->GetMultiThreader()->ParallelizeArray(
+    0,
+    region.GetSize(SlowDimension),
+    [&](SizeValueType slice) {
+      OutputImageRegionType sliceRegion = region;
+      sliceRegion.SetIndex(SlowDimension, region.GetIndex(SlowDimension) + static_cast<IndexValueType>(slice));
+      sliceRegion.SetSize(SlowDimension, 1);
+
+      ImageScanlineIterator<OutputImageType> it(output, sliceRegion);
+      while (!it.IsAtEnd())
+      {
+        // Nearest pixel of the box to the start of the line.
+        const IndexType lineIndex = it.GetIndex();
+        IndexType       nearest;
+        bool            lineInBox = true;
+        for (unsigned int d = 0; d <= SlowDimension; ++d)
+        {
+          nearest[d] = std::min(std::max(lineIndex[d], lower[d]), upper[d]);
+          lineInBox = lineInBox && (d == 0 || nearest[d] == lineIndex[d]);
+        }
+        nearest[0] = lower[0];
+
+        const OutputPixelType * boxLine = boxBuffer + boxOutput->ComputeOffset(nearest);
+        const InputPixelType *  inputLine = inputBuffer + input->ComputeOffset(lineIndex);
+
+        for (IndexValueType x = lineIndex[0]; !it.IsAtEndOfLine(); ++x, ++it)
+        {
+          if (m_CopyInputOutside && (!lineInBox || x < lower[0] || x > upper[0]))
+          {
+            it.Set(static_cast<OutputPixelType>(inputLine[x - lineIndex[0]]));
+          }
+          else
+          {
+            it.Set(boxLine[std::min(std::max(x, lower[0]), upper[0]) - lower[0]]);
+          }
+        }
+        it.NextLine();
+      }
+    },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CropToForegroundImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  itkPrintSelfObjectMacro(Filter);
+  os << indent << "ForegroundValue: " << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_ForegroundValue)
+     << std::endl;
+  os << indent << "Padding: " << m_Padding << std::endl;
+  os << indent << "CopyInputOutside: " << (m_CopyInputOutside ? "On" : "Off") << std::endl;
+  os << indent << "BoundingBox: " << m_BoundingBox << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,135 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkFastBinaryBallDilateImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkFastBinaryBallDilateImageFilter_h
+#define itkFastBinaryBallDilateImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+#include <cstdint>
+
+namespace itk
+{
+
+/** \class FastBinaryBallDilateImageFilter
+ * \brief BinaryDilateImageFilter with a BinaryBallStructuringElement, in a
+ * time that does not depend on the radius.
+ *
+ * The ball of radius r holds the offsets whose squared length is at most
+ * r * r + r. A pixel is therefore reached by the dilation exactly when its
+ * squared Euclidean distance to the nearest foreground pixel is at most
+ * that bound. The filter computes the exact squared distance transform one
+ * dimension at a time, as the lower envelope of parabolas along every
+ * line, with the lines of each dimension processed in parallel. Distances
+ * beyond the bound are clamped to it plus one, which keeps them in 32 bits
+ * and lets the envelopes skip the lines far from the foreground. The last
+ * dimension writes the output directly.
+ *
+ * Below MinimumDistanceTransformRadius the ball is small enough for
+ * BinaryDilateImageFilter to be faster, and the filter runs it instead.
+ *
+ * Either way the output is that of BinaryDilateImageFilter: the dilated
+ * pixels hold ForegroundValue and the others keep their input value.
+ */
+template <typename TInputImage, typename TOutputImage = TInputImage>
+class ITK_TEMPLATE_EXPORT FastBinaryBallDilateImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(FastBinaryBallDilateImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = FastBinaryBallDilateImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(FastBinaryBallDilateImageFilter);
+
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  using InputImageType = TInputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+
+  using OutputImageType = TOutputImage;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  /** Squared distances, clamped past the ball. */
+  using DistanceType = std::uint32_t;
+
+  /** Lines per block of a distance transform pass are chosen to hold about
+   * this many pixels. */
+  static constexpr SizeValueType PixelsPerBlock = 65536;
+
+  /** Radius of the ball, in pixels. */
+  itkSetMacro(Radius, unsigned int);
+  itkGetConstMacro(Radius, unsigned int);
+
+  itkSetMacro(ForegroundValue, InputPixelType);
+  itkGetConstMacro(ForegroundValue, InputPixelType);
+
+  /** Smallest radius dilated through the distance transform. Smaller balls
+   * go through BinaryDilateImageFilter. */
+  itkSetMacro(MinimumDistanceTransformRadius, unsigned int);
+  itkGetConstMacro(MinimumDistanceTransformRadius, unsigned int);
+
+protected:
+  FastBinaryBallDilateImageFilter();
+  ~FastBinaryBallDilateImageFilter() override = default;
+
+  /** Foreground anywhere in the image can reach any output pixel. */
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** Dilate with BinaryDilateImageFilter. */
+  void
+  DirectDilate();
+
+  /** Squared distance along the lines of the first dimension. */
+  void
+  ComputeLineDistances(DistanceType * distance, DistanceType outside) const;
+
+  /** Lower envelope of the parabolas along the lines of a dimension, in
+   * place. On the last dimension the output is written instead. */
+  void
+  ComputeEnvelopes(unsigned int dimension, DistanceType * distance, DistanceType outside);
+
+  unsigned int   m_Radius{ 1 };
+  InputPixelType m_ForegroundValue{};
+  unsigned int   m_MinimumDistanceTransformRadius{ 4 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkFastBinaryBallDilateImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,293 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkFastBinaryBallDilateImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkFastBinaryBallDilateImageFilter_hxx
+#define itkFastBinaryBallDilateImageFilter_hxx
+
+#include "itkBinaryBallStructuringElement.h"
+#include "itkBinaryDilateImageFilter.h"
+#include "itkMultiThreaderBase.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+FastBinaryBallDilateImageFilter<TInputImage, TOutputImage>::FastBinaryBallDilateImageFilter()
+{
+  m_ForegroundValue = NumericTraits<InputPixelType>::max();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FastBinaryBallDilateImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  if (this->GetInput())
+  {
+    auto * input = const_cast<InputImageType *>(this->GetInput());
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FastBinaryBallDilateImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FastBinaryBallDilateImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  if (m_Radius < m_MinimumDistanceTransformRadius)
+  {
+    this->DirectDilate();
+    return;
+  }
+
+  // The ball holds the offsets of squared length up to r * r + r, which is
+  // below (r + 1)^2; anything farther is only known to be outside.
+  const std::uint64_t bound = std::uint64_t{ m_Radius } * m_Radius + m_Radius;
+  if (bound >= std::numeric_limits<DistanceType>::max())
+  {
+    itkExceptionMacro(<< "Radius " << m_Radius << " is too large for the distance transform");
+  }
+  const auto outside = static_cast<DistanceType>(bound + 1);
+
+  OutputImageType * outputImage = this->GetOutput();
+  outputImage->SetBufferedRegion(outputImage->GetRequestedRegion());
+  outputImage->Allocate();
+
+  this->GetMultiThreader()->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  const SizeValueType             numberOfPixels = outputImage->GetRequestedRegion().GetNumberOfPixels();
+  std::unique_ptr<DistanceType[]> distance(new DistanceType[numberOfPixels]);
+
+  this->ComputeLineDistances(distance.get(), outside);
+  for (unsigned int d = 1; d < ImageDimension; ++d)
+  {
+    this->ComputeEnvelopes(d, distance.get(), outside);
+  }
+
+  if (ImageDimension == 1)
+  {
+    const InputPixelType * input = this->GetInput()->GetBufferPointer();
+    OutputPixelType *      output = outputImage->GetBufferPointer();
+    const auto             foreground = static_cast<OutputPixelType>(m_ForegroundValue);
+    for (SizeValueType offset = 0; offset < numberOfPixels; ++offset)
+    {
+      output[offset] = distance[offset] < outside ? foreground : static_cast<OutputPixelType>(input[offset]);
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FastBinaryBallDilateImageFilter<TInputImage, TOutputImage>::DirectDilate()
+{
+  using KernelType = BinaryBallStructuringElement<InputPixelType, ImageDimension>;
+  using DilateFilterType = BinaryDilateImageFilter<InputImageType, OutputImageType, KernelType>;
+
+  KernelType ball;
+  ball.SetRadius(m_Radius);
+  ball.CreateStructuringElement();
+
+  auto dilate = DilateFilterType::New();
+  dilate->SetInput(this->GetInput());
+  dilate->SetKernel(ball);
+  dilate->SetForegroundValue(m_ForegroundValue);
+  dilate->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  dilate->GraftOutput(this->GetOutput());
+  dilate->Update();
+  this->GraftOutput(dilate->GetOutput());
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FastBinaryBallDilateImageFilter<TInputImage, TOutputImage>::ComputeLineDistances(DistanceType * distance,
+                                                                                 DistanceType   outside) const
+{
+  const InputImageType * inputImage = this->GetInput();
+  const InputPixelType * input = inputImage->GetBufferPointer();
+  const SizeValueType    length = inputImage->GetBufferedRegion().GetSize(0);
+  const SizeValueType    numberOfLines = inputImage->GetBufferedRegion().GetNumberOfPixels() / length;
+  const SizeValueType    linesPerBlock = std::max<SizeValueType>(1, PixelsPerBlock / length);
+  const InputPixelType   foreground = m_ForegroundValue;
+
+  // Linear distances past the radius are all outside, which keeps the
+  // squares from overflowing.
+  const SizeValueType farthest = m_Radius + 1;
+  const auto          square = [outside](SizeValueType d) {
+    return static_cast<DistanceType>(std::min<std::uint64_t>(std::uint64_t{ d } * d, outside));
+  };
+
+  this->GetMultiThreader()->ParallelizeArray(
+    0,
+    (numberOfLines + linesPerBlock - 1) / linesPerBlock,
+    [&](SizeValueType block) {
+      const SizeValueType lastLine = std::min(numberOfLines, (block + 1) * linesPerBlock);
+      for (SizeValueType line = block * linesPerBlock; line < lastLine; ++line)
+      {
+        const InputPixelType * in = input + line * length;
+        DistanceType *         out = distance + line * length;
+
+        // Distance to the nearest foreground pixel on the left, then on the right.
+        SizeValueType gap = farthest;
+        for (SizeValueType i = 0; i < length; ++i)
+        {
+          gap = in[i] == foreground ? 0 : std::min(gap + 1, farthest);
+          out[i] = square(gap);
+        }
+        gap = farthest;
+        for (SizeValueType i = length; i-- > 0;)
+        {
+          gap = in[i] == foreground ? 0 : std::min(gap + 1, farthest);
+          out[i] = std::min(out[i], square(gap));
+        }
+      }
+    },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FastBinaryBallDilateImageFilter<TInputImage, TOutputImage>::ComputeEnvelopes(unsigned int   dimension,
+                                                                             DistanceType * distance,
+                                                                             DistanceType   outside)
+{
+  const OutputImageRegionType region = this->GetOutput()->GetBufferedRegion();
+  const bool                  writeOutput = dimension == ImageDimension - 1;
+
+  SizeValueType stride = 1;
+  for (unsigned int d = 0; d < dimension; ++d)
+  {
+    stride *= region.GetSize(d);
+  }
+  const SizeValueType length = region.GetSize(dimension);
+  const SizeValueType numberOfLines = region.GetNumberOfPixels() / length;
+  const SizeValueType linesPerBlock = std::max<SizeValueType>(1, PixelsPerBlock / length);
+
+  const InputPixelType * input = this->GetInput()->GetBufferPointer();
+  OutputPixelType *      output = this->GetOutput()->GetBufferPointer();
+  const auto             foreground = static_cast<OutputPixelType>(m_ForegroundValue);
+
+  this->GetMultiThreader()->ParallelizeArray(
+    0,
+    (numberOfLines + linesPerBlock - 1) / linesPerBlock,
+    [&](SizeValueType block) {
+      // Values along the line, and the parabolas of the lower envelope: their
+      // apex, their height plus the squared apex, and where they start.
+      std::vector<DistanceType>  values(length);
+      std::vector<SizeValueType> apex(length);
+      std::vector<double>        height(length);
+      std::vector<double>        start(length);
+
+      const SizeValueType lastLine = std::min(numberOfLines, (block + 1) * linesPerBlock);
+      for (SizeValueType line = block * linesPerBlock; line < lastLine; ++line)
+      {
+        const SizeValueType first = (line / stride) * stride * length + line % stride;
+
+        // Pixels outside the ball cannot bring anything in range, so only
+        // the others become parabolas.
+        SizeValueType numberOfParabolas = 0;
+        for (SizeValueType q = 0; q < length; ++q)
+        {
+          values[q] = distance[first + q * stride];
+          if (values[q] >= outside)
+          {
+            continue;
+          }
+          const double h = values[q] + static_cast<double>(q) * q;
+          double       s = -std::numeric_limits<double>::infinity();
+          while (numberOfParabolas > 0)
+          {
+            const SizeValueType k = numberOfParabolas - 1;
+            s = (h - height[k]) / (2.0 * static_cast<double>(q - apex[k]));
+            if (s > start[k])
+            {
+              break;
+            }
+            --numberOfParabolas;
+            s = -std::numeric_limits<double>::infinity();
+          }
+          apex[numberOfParabolas] = q;
+          height[numberOfParabolas] = h;
+          start[numberOfParabolas] = s;
+          ++numberOfParabolas;
+        }
+
+        SizeValueType k = 0;
+        for (SizeValueType q = 0; q < length; ++q)
+        {
+          DistanceType value = outside;
+          if (numberOfParabolas > 0)
+          {
+            while (k + 1 < numberOfParabolas && start[k + 1] < static_cast<double>(q))
+            {
+              ++k;
+            }
+            const SizeValueType  step = q > apex[k] ? q - apex[k] : apex[k] - q;
+            const std::uint64_t candidate = std::uint64_t{ step } * step + values[apex[k]];
+            value = static_cast<DistanceType>(std::min<std::uint64_t>(candidate, outside));
+          }
+
+          const SizeValueType offset = first + q * stride;
+          if (writeOutput)
+          {
+            output[offset] = value < outside ? foreground : static_cast<OutputPixelType>(input[offset]);
+          }
+          else
+          {
+            distance[offset] = value;
+          }
+        }
+      }
+    },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FastBinaryBallDilateImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Radius: " << m_Radius << std::endl;
+  os << indent << "ForegroundValue: " << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_ForegroundValue)
+     << std::endl;
+  os << indent << "MinimumDistanceTransformRadius: " << m_MinimumDistanceTransformRadius << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,144 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkForegroundBoundingBox.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkForegroundBoundingBox_h
+#define itkForegroundBoundingBox_h
+
+#include "itkMultiThreaderBase.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+
+/** Smallest region of the buffer of \a image that holds every pixel equal
+ * to \a foreground, or a region of size zero when there is none.
+ *
+ * The slices across the slowest dimension are scanned in parallel on the
+ * work units of \a multiThreader. Each line is only read up to its first
+ * foreground pixel from either end. */
+template <typename TImage>
+typename TImage::RegionType
+ComputeForegroundBoundingBox(const TImage *                      image,
+                             const typename TImage::PixelType & foreground,
+                             MultiThreaderBase *                 multiThreader)
+{
+  using RegionType = typename TImage::RegionType;
+  using IndexType = typename TImage::IndexType;
+  using PixelType = typename TImage::PixelType;
+
+  constexpr unsigned int Dimension = TImage::ImageDimension;
+
+  const RegionType region = image->GetBufferedRegion();
+  if (region.GetNumberOfPixels() == 0)
+  {
+    return RegionType();
+  }
+
+  const PixelType *    buffer = image->GetBufferPointer();
+  const SizeValueType  length = region.GetSize(0);
+  const SizeValueType  numberOfSlices = Dimension > 1 ? region.GetSize(Dimension - 1) : 1;
+  const SizeValueType  linesPerSlice = region.GetNumberOfPixels() / length / numberOfSlices;
+  const SizeValueType  pixelsPerSlice = linesPerSlice * length;
+  const IndexType      start = region.GetIndex();
+  const IndexValueType none = NumericTraits<IndexValueType>::max();
+
+  // Extent of the foreground of every slice, merged afterwards.
+  std::vector<IndexType> lower(numberOfSlices);
+  std::vector<IndexType> upper(numberOfSlices);
+
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfSlices,
+    [&](SizeValueType slice) {
+      IndexType & low = lower[slice];
+      IndexType & high = upper[slice];
+      low.Fill(none);
+      high.Fill(NumericTraits<IndexValueType>::NonpositiveMin());
+
+      for (SizeValueType line = 0; line < linesPerSlice; ++line)
+      {
+        const PixelType * pixels = buffer + slice * pixelsPerSlice + line * length;
+
+        SizeValueType first = 0;
+        while (first < length && pixels[first] != foreground)
+        {
+          ++first;
+        }
+        if (first == length)
+        {
+          continue;
+        }
+        SizeValueType last = length - 1;
+        while (pixels[last] != foreground)
+        {
+          --last;
+        }
+
+        low[0] = std::min(low[0], start[0] + static_cast<IndexValueType>(first));
+        high[0] = std::max(high[0], start[0] + static_cast<IndexValueType>(last));
+
+        SizeValueType rest = line;
+        for (unsigned int d = 1; d < Dimension; ++d)
+        {
+          IndexValueType index;
+          if (d + 1 < Dimension)
+          {
+            index = start[d] + static_cast<IndexValueType>(rest % region.GetSize(d));
+            rest /= region.GetSize(d);
+          }
+          else
+          {
+            index = start[d] + static_cast<IndexValueType>(slice);
+          }
+          low[d] = std::min(low[d], index);
+          high[d] = std::max(high[d], index);
+        }
+      }
+    },
+    nullptr);
+
+  IndexType low;
+  IndexType high;
+  low.Fill(none);
+  high.Fill(NumericTraits<IndexValueType>::NonpositiveMin());
+  for (SizeValueType slice = 0; slice < numberOfSlices; ++slice)
+  {
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      low[d] = std::min(low[d], lower[slice][d]);
+      high[d] = std::max(high[d], upper[slice][d]);
+    }
+  }
+
+  RegionType box;
+  if (low[0] == none)
+  {
+    return box;
+  }
+  box.SetIndex(low);
+  for (unsigned int d = 0; d < Dimension; ++d)
+  {
+    box.SetSize(d, static_cast<SizeValueType>(high[d] - low[d] + 1));
+  }
+  return box;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,234 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMultiLabelVectorConfidenceConnectedImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkMultiLabelVectorConfidenceConnectedImageFilter_h
+#define itkMultiLabelVectorConfidenceConnectedImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkMahalanobisDistanceThresholdImageFunction.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace itk
+{
+
+/** \class MultiLabelVectorConfidenceConnectedImageFilter
+ * \brief Grows several confidence-connected regions at once into a label
+ * image.
+ *
+ * Every seed set is one tissue, with its own multiplier and its own mean
+ * and covariance, computed as in VectorConfidenceConnectedImageFilter. The
+ * seed sets are numbered from 1 in the order they are added, and the
+ * output holds that label on the region of the set and zero elsewhere.
+ *
+ * All the regions grow together in the level-synchronous waves of
+ * ParallelVectorConfidenceConnectedImageFilter. A pixel reached by several
+ * regions goes to the one that reaches it in the fewest steps from its
+ * seeds, ties going to the lowest label, so the output does not depend on
+ * the number of threads. A label that rejects a pixel marks it in a bit
+ * image of its own, so it tests every pixel at most once per growth
+ * whatever the number of its neighbours in the region. The statistics of
+ * all the labels are recomputed
+ * in a single pass over the image per iteration. With a single seed set
+ * the output is the region of VectorConfidenceConnectedImageFilter.
+ *
+ * The iterations stop early once the statistics of every label are the
+ * ones the regions were last grown with; ElapsedIterations reports how
+ * many were run.
+ *
+ * The input must be an Image of fixed-length vector pixels whose buffer
+ * covers the largest possible region.
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT MultiLabelVectorConfidenceConnectedImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(MultiLabelVectorConfidenceConnectedImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = MultiLabelVectorConfidenceConnectedImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(MultiLabelVectorConfidenceConnectedImageFilter);
+
+  using InputImageType = TInputImage;
+  using InputImagePixelType = typename InputImageType::PixelType;
+  using IndexType = typename InputImageType::IndexType;
+
+  using OutputImageType = TOutputImage;
+  using OutputImagePixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  using SeedsContainerType = std::vector<IndexType>;
+
+  using DistanceThresholdFunctionType = MahalanobisDistanceThresholdImageFunction<InputImageType>;
+  using CovarianceMatrixType = typename DistanceThresholdFunctionType::CovarianceMatrixType;
+  using MeanVectorType = typename DistanceThresholdFunctionType::MeanVectorType;
+
+  /** Largest number of seed sets. */
+  static constexpr unsigned int MaximumNumberOfLabels = 127;
+
+  /** Pixels per block of the buffer-order passes, and frontier entries per
+   * chunk of a growing wave. */
+  static constexpr SizeValueType PixelsPerBlock = 65536;
+  static constexpr SizeValueType FrontierChunkSize = 1024;
+
+  /** Add a seed set grown with its own multiplier. Returns its label.
+   * Throws when the set is empty, which would leave the label without
+   * statistics. */
+  unsigned int
+  AddSeedSet(const SeedsContainerType & seeds, double multiplier);
+
+  /** Remove all seed sets. */
+  void
+  ClearSeedSets();
+
+  unsigned int
+  GetNumberOfLabels() const
+  {
+    return static_cast<unsigned int>(m_SeedSets.size());
+  }
+
+  /** Seeds and multiplier of a label, numbered from 1. */
+  const SeedsContainerType &
+  GetSeeds(unsigned int label) const
+  {
+    return m_SeedSets[label - 1];
+  }
+
+  double
+  GetMultiplier(unsigned int label) const
+  {
+    return m_Multipliers[label - 1];
+  }
+
+  /** Number of times the statistics are recomputed and the regions regrown. */
+  itkSetMacro(NumberOfIterations, unsigned int);
+  itkGetConstMacro(NumberOfIterations, unsigned int);
+
+  /** Radius of the neighbourhoods the initial statistics are taken from. */
+  itkSetMacro(InitialNeighborhoodRadius, unsigned int);
+  itkGetConstReferenceMacro(InitialNeighborhoodRadius, unsigned int);
+
+  /** Number of iterations run by the last update. */
+  itkGetConstMacro(ElapsedIterations, unsigned int);
+
+  /** Statistics a label was last grown with. */
+  const MeanVectorType &
+  GetMean(unsigned int label) const
+  {
+    return m_ThresholdFunctions[label - 1]->GetMean();
+  }
+
+  const CovarianceMatrixType &
+  GetCovariance(unsigned int label) const
+  {
+    return m_ThresholdFunctions[label - 1]->GetCovariance();
+  }
+
+protected:
+  MultiLabelVectorConfidenceConnectedImageFilter() = default;
+  ~MultiLabelVectorConfidenceConnectedImageFilter() override = default;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  using StatusType = std::atomic<unsigned char>;
+  using RejectedWordType = std::atomic<std::uint64_t>;
+  using FrontierType = std::vector<IndexType>;
+
+  /** A pixel holds the zero-based label that owns it, ProposedBy plus the
+   * label while a wave is deciding between the labels reaching it, or
+   * Unowned. Smaller values win, so earlier waves beat later ones. */
+  enum : unsigned char
+  {
+    ProposedBy = 128,
+    Unowned = 255
+  };
+
+  /** Run function(block, begin, end) over fixed blocks of [0, numberOfElements). */
+  void
+  ParallelizeBlocks(SizeValueType                                                            numberOfElements,
+                    const std::function<void(SizeValueType, SizeValueType, SizeValueType)> & function) const;
+
+  /** Propose a pixel for a label when the label accepts it and no earlier
+   * wave or lower label holds it. Returns true when the proposal stands.
+   * A pixel the label rejects is marked and never tested again. */
+  bool
+  ProposePixel(unsigned int label, const IndexType & index, OffsetValueType offset);
+
+  /** Grow all the regions from their seeds with the current statistics. */
+  void
+  GrowRegions();
+
+  /** Count, component sums and product sums of every label, in one pass. */
+  void
+  ComputeLabelSums(std::vector<double> & sums) const;
+
+  SizeValueType
+  GetSumsStride() const
+  {
+    const SizeValueType dimension = this->GetInput()->GetNumberOfComponentsPerPixel();
+    return 1 + dimension + dimension * dimension;
+  }
+
+  std::vector<SeedsContainerType> m_SeedSets;
+  std::vector<double>             m_Multipliers;
+
+  unsigned int m_NumberOfIterations{ 4 };
+  unsigned int m_InitialNeighborhoodRadius{ 1 };
+  unsigned int m_ElapsedIterations{ 0 };
+
+  std::vector<typename DistanceThresholdFunctionType::Pointer> m_ThresholdFunctions;
+
+  std::unique_ptr<StatusType[]> m_Status;
+
+  /** One bit per pixel and label, set once the label rejected the pixel,
+   * in words of RejectedWordBits pixels; every label has m_RejectedStride
+   * words. */
+  static constexpr SizeValueType      RejectedWordBits = 64;
+  std::unique_ptr<RejectedWordType[]> m_Rejected;
+  SizeValueType                       m_RejectedStride{ 0 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkMultiLabelVectorConfidenceConnectedImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,518 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMultiLabelVectorConfidenceConnectedImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkMultiLabelVectorConfidenceConnectedImageFilter_hxx
+#define itkMultiLabelVectorConfidenceConnectedImageFilter_hxx
+
+#include "itkCovarianceImageFunction.h"
+#include "itkMultiThreaderBase.h"
+#include "itkNumericTraits.h"
+#include "itkVectorMeanImageFunction.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+unsigned int
+MultiLabelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::AddSeedSet(const SeedsContainerType & seeds,
+                                                                                      double multiplier)
+{
+  if (m_SeedSets.size() >= MaximumNumberOfLabels)
+  {
+    itkExceptionMacro(<< "At most " << MaximumNumberOfLabels << " seed sets are supported");
+  }
+  if (seeds.empty())
+  {
+    itkExceptionMacro(<< "A seed set needs at least one seed");
+  }
+
+  m_SeedSets.push_back(seeds);
+  m_Multipliers.push_back(multiplier);
+  m_ThresholdFunctions.push_back(DistanceThresholdFunctionType::New());
+  this->Modified();
+
+  return this->GetNumberOfLabels();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+MultiLabelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::ClearSeedSets()
+{
+  if (!m_SeedSets.empty())
+  {
+    m_SeedSets.clear();
+    m_Multipliers.clear();
+    m_ThresholdFunctions.clear();
+    this->Modified();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+MultiLabelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  if (this->GetInput())
+  {
+    auto * input = const_cast<InputImageType *>(this->GetInput());
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+MultiLabelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(
+  DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+MultiLabelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  const InputImageType * inputImage = this->GetInput();
+  OutputImageType *      outputImage = this->GetOutput();
+
+  const OutputImageRegionType region = outputImage->GetRequestedRegion();
+  outputImage->SetBufferedRegion(region);
+  outputImage->Allocate();
+
+  this->GetMultiThreader()->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  const unsigned int numberOfLabels = this->GetNumberOfLabels();
+  const unsigned int dimension = inputImage->GetNumberOfComponentsPerPixel();
+
+  auto meanFunction = VectorMeanImageFunction<InputImageType>::New();
+  meanFunction->SetInputImage(inputImage);
+  meanFunction->SetNeighborhoodRadius(m_InitialNeighborhoodRadius);
+
+  auto covarianceFunction = CovarianceImageFunction<InputImageType>::New();
+  covarianceFunction->SetInputImage(inputImage);
+  covarianceFunction->SetNeighborhoodRadius(m_InitialNeighborhoodRadius);
+
+  MeanVectorType       mean(dimension);
+  CovarianceMatrixType covariance(dimension, dimension);
+
+  // Initial statistics of every label, the average over its seeds of the
+  // mean and the covariance of their neighbourhoods.
+  for (unsigned int label = 0; label < numberOfLabels; ++label)
+  {
+    const SeedsContainerType & seeds = m_SeedSets[label];
+
+    mean.fill(0.0);
+    covariance.fill(0.0);
+    for (const auto & seed : seeds)
+    {
+      const auto meanContribution = meanFunction->EvaluateAtIndex(seed);
+      const auto covarianceContribution = covarianceFunction->EvaluateAtIndex(seed);
+      for (unsigned int i = 0; i < dimension; ++i)
+      {
+        mean[i] += meanContribution[i];
+        for (unsigned int j = 0; j < dimension; ++j)
+        {
+          covariance[i][j] += covarianceContribution[i][j];
+        }
+      }
+    }
+    for (unsigned int i = 0; i < dimension; ++i)
+    {
+      mean[i] /= seeds.size();
+      for (unsigned int j = 0; j < dimension; ++j)
+      {
+        covariance[i][j] /= seeds.size();
+      }
+    }
+
+    DistanceThresholdFunctionType * thresholdFunction = m_ThresholdFunctions[label];
+    thresholdFunction->SetInputImage(inputImage);
+    thresholdFunction->SetMean(mean);
+    thresholdFunction->SetCovariance(covariance);
+
+    double threshold = m_Multipliers[label];
+    for (const auto & seed : seeds)
+    {
+      threshold = std::max(threshold, thresholdFunction->EvaluateDistanceAtIndex(seed));
+    }
+    thresholdFunction->SetThreshold(threshold);
+  }
+
+  m_Status.reset(new StatusType[region.GetNumberOfPixels()]);
+  m_RejectedStride = (region.GetNumberOfPixels() + RejectedWordBits - 1) / RejectedWordBits;
+  m_Rejected.reset(new RejectedWordType[numberOfLabels * m_RejectedStride]);
+  m_ElapsedIterations = 0;
+
+  this->GrowRegions();
+  this->UpdateProgress(1.0f / (m_NumberOfIterations + 1));
+
+  const SizeValueType stride = this->GetSumsStride();
+  std::vector<double> sums;
+  std::vector<double> grownSums;
+
+  while (m_ElapsedIterations < m_NumberOfIterations)
+  {
+    this->ComputeLabelSums(sums);
+
+    // The regions were grown with these very statistics, regrowing them
+    // would give the same regions again.
+    if (sums == grownSums)
+    {
+      break;
+    }
+
+    for (unsigned int label = 0; label < numberOfLabels; ++label)
+    {
+      const double   numberOfRegionPixels = sums[label * stride];
+      const double * sum = sums.data() + label * stride + 1;
+      const double * products = sum + dimension;
+
+      // A label whose seeds all went to other labels has no region; it
+      // keeps the statistics it had.
+      if (numberOfRegionPixels == 0.0)
+      {
+        continue;
+      }
+
+      for (unsigned int i = 0; i < dimension; ++i)
+      {
+        mean[i] = sum[i] / numberOfRegionPixels;
+        for (unsigned int j = 0; j < dimension; ++j)
+        {
+          covariance[i][j] = products[i * dimension + j] / numberOfRegionPixels;
+        }
+      }
+      for (unsigned int i = 0; i < dimension; ++i)
+      {
+        for (unsigned int j = 0; j < dimension; ++j)
+        {
+          covariance[i][j] -= mean[i] * mean[j];
+        }
+      }
+
+      m_ThresholdFunctions[label]->SetMean(mean);
+      m_ThresholdFunctions[label]->SetCovariance(covariance);
+    }
+
+    this->GrowRegions();
+    grownSums.swap(sums);
+    ++m_ElapsedIterations;
+    this->UpdateProgress(static_cast<float>(m_ElapsedIterations + 1) / (m_NumberOfIterations + 1));
+  }
+
+  OutputImagePixelType *     output = outputImage->GetBufferPointer();
+  const OutputImagePixelType zero = NumericTraits<OutputImagePixelType>::ZeroValue();
+
+  this->ParallelizeBlocks(region.GetNumberOfPixels(), [&](SizeValueType, SizeValueType begin, SizeValueType end) {
+    for (SizeValueType offset = begin; offset < end; ++offset)
+    {
+      const unsigned char status = m_Status[offset].load(std::memory_order_relaxed);
+      output[offset] = status < ProposedBy ? static_cast<OutputImagePixelType>(status + 1) : zero;
+    }
+  });
+
+  m_Status.reset();
+  m_Rejected.reset();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+MultiLabelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::ParallelizeBlocks(
+  SizeValueType                                                            numberOfElements,
+  const std::function<void(SizeValueType, SizeValueType, SizeValueType)> & function) const
+{
+  this->GetMultiThreader()->ParallelizeArray(
+    0,
+    (numberOfElements + PixelsPerBlock - 1) / PixelsPerBlock,
+    [&](SizeValueType block) {
+      function(block, block * PixelsPerBlock, std::min(numberOfElements, (block + 1) * PixelsPerBlock));
+    },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+bool
+MultiLabelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::ProposePixel(unsigned int      label,
+                                                                                        const IndexType & index,
+                                                                                        OffsetValueType   offset)
+{
+  StatusType &        status = m_Status[offset];
+  const unsigned char proposal = static_cast<unsigned char>(ProposedBy + label);
+
+  RejectedWordType &  rejected = m_Rejected[label * m_RejectedStride + offset / RejectedWordBits];
+  const std::uint64_t bit = std::uint64_t{ 1 } << (offset % RejectedWordBits);
+
+  if (status.load(std::memory_order_relaxed) <= proposal || (rejected.load(std::memory_order_relaxed) & bit))
+  {
+    return false;
+  }
+  if (!m_ThresholdFunctions[label]->EvaluateAtIndex(index))
+  {
+    rejected.fetch_or(bit, std::memory_order_relaxed);
+    return false;
+  }
+
+  unsigned char current = status.load(std::memory_order_relaxed);
+  while (current > proposal)
+  {
+    if (status.compare_exchange_weak(current, proposal, std::memory_order_relaxed))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+MultiLabelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::GrowRegions()
+{
+  constexpr unsigned int ImageDimension = OutputImageType::ImageDimension;
+
+  const OutputImageType *     outputImage = this->GetOutput();
+  const OutputImageRegionType region = outputImage->GetBufferedRegion();
+  const unsigned int          numberOfLabels = this->GetNumberOfLabels();
+
+  this->ParallelizeBlocks(region.GetNumberOfPixels(), [&](SizeValueType, SizeValueType begin, SizeValueType end) {
+    for (SizeValueType offset = begin; offset < end; ++offset)
+    {
+      m_Status[offset].store(Unowned, std::memory_order_relaxed);
+    }
+  });
+  this->ParallelizeBlocks(
+    numberOfLabels * m_RejectedStride, [&](SizeValueType, SizeValueType begin, SizeValueType end) {
+      for (SizeValueType word = begin; word < end; ++word)
+      {
+        m_Rejected[word].store(0, std::memory_order_relaxed);
+      }
+    });
+
+  IndexValueType first[ImageDimension];
+  IndexValueType last[ImageDimension];
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    first[d] = region.GetIndex(d);
+    last[d] = first[d] + static_cast<IndexValueType>(region.GetSize(d)) - 1;
+  }
+
+  // A wave is cut into items, each a chunk of the frontier of one label.
+  // The proposals of an item become its candidates; once all the items
+  // have proposed, the candidates that kept their proposal are owned and
+  // form the next frontier of the label.
+  struct WaveItem
+  {
+    unsigned int  Label;
+    SizeValueType Begin;
+    SizeValueType End;
+    FrontierType  Candidates;
+  };
+
+  const auto keepOwnedCandidates = [&](WaveItem & item) {
+    const auto proposal = static_cast<unsigned char>(ProposedBy + item.Label);
+    SizeValueType kept = 0;
+    for (const auto & candidate : item.Candidates)
+    {
+      StatusType & status = m_Status[outputImage->ComputeOffset(candidate)];
+      if (status.load(std::memory_order_relaxed) == proposal)
+      {
+        status.store(static_cast<unsigned char>(item.Label), std::memory_order_relaxed);
+        item.Candidates[kept++] = candidate;
+      }
+    }
+    item.Candidates.resize(kept);
+  };
+
+  std::vector<FrontierType> frontiers(numberOfLabels);
+  std::vector<WaveItem>     items;
+
+  // The seeds make the first wave.
+  for (unsigned int label = 0; label < numberOfLabels; ++label)
+  {
+    WaveItem item{ label, 0, 0, FrontierType() };
+    for (const auto & seed : m_SeedSets[label])
+    {
+      if (region.IsInside(seed) && this->ProposePixel(label, seed, outputImage->ComputeOffset(seed)))
+      {
+        item.Candidates.push_back(seed);
+      }
+    }
+    items.push_back(std::move(item));
+  }
+  for (auto & item : items)
+  {
+    keepOwnedCandidates(item);
+    frontiers[item.Label].swap(item.Candidates);
+  }
+
+  while (true)
+  {
+    items.clear();
+    for (unsigned int label = 0; label < numberOfLabels; ++label)
+    {
+      for (SizeValueType begin = 0; begin < frontiers[label].size(); begin += FrontierChunkSize)
+      {
+        const SizeValueType end = std::min<SizeValueType>(frontiers[label].size(), begin + FrontierChunkSize);
+        items.push_back(WaveItem{ label, begin, end, FrontierType() });
+      }
+    }
+    if (items.empty())
+    {
+      break;
+    }
+
+    const auto expandItem = [&](SizeValueType i) {
+      WaveItem &           item = items[i];
+      const FrontierType & frontier = frontiers[item.Label];
+
+      for (SizeValueType k = item.Begin; k < item.End; ++k)
+      {
+        const IndexType & index = frontier[k];
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          IndexType neighbor = index;
+          if (index[d] > first[d])
+          {
+            neighbor[d] = index[d] - 1;
+            if (this->ProposePixel(item.Label, neighbor, outputImage->ComputeOffset(neighbor)))
+            {
+              item.Candidates.push_back(neighbor);
+            }
+          }
+          if (index[d] < last[d])
+          {
+            neighbor[d] = index[d] + 1;
+            if (this->ProposePixel(item.Label, neighbor, outputImage->ComputeOffset(neighbor)))
+            {
+              item.Candidates.push_back(neighbor);
+            }
+          }
+        }
+      }
+    };
+
+    if (items.size() == 1)
+    {
+      expandItem(0);
+      keepOwnedCandidates(items[0]);
+    }
+    else
+    {
+      this->GetMultiThreader()->ParallelizeArray(0, items.size(), expandItem, nullptr);
+      this->GetMultiThreader()->ParallelizeArray(
+        0, items.size(), [&](SizeValueType i) { keepOwnedCandidates(items[i]); }, nullptr);
+    }
+
+    for (auto & frontier : frontiers)
+    {
+      frontier.clear();
+    }
+    for (const auto & item : items)
+    {
+      FrontierType & frontier = frontiers[item.Label];
+      frontier.insert(frontier.end(), item.Candidates.begin(), item.Candidates.end());
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+MultiLabelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::ComputeLabelSums(
+  std::vector<double> & sums) const
+{
+  const InputImagePixelType * input = this->GetInput()->GetBufferPointer();
+  const unsigned int          dimension = this->GetInput()->GetNumberOfComponentsPerPixel();
+  const SizeValueType         stride = this->GetSumsStride();
+  const SizeValueType         labelsStride = stride * this->GetNumberOfLabels();
+  const SizeValueType         numberOfPixels = this->GetOutput()->GetBufferedRegion().GetNumberOfPixels();
+  const SizeValueType         numberOfBlocks = (numberOfPixels + PixelsPerBlock - 1) / PixelsPerBlock;
+
+  // Summed block by block in buffer order, one set of sums per label.
+  std::vector<double> blockSums(numberOfBlocks * labelsStride, 0.0);
+
+  this->ParallelizeBlocks(numberOfPixels, [&](SizeValueType block, SizeValueType begin, SizeValueType end) {
+    double * labelSums = blockSums.data() + block * labelsStride;
+    for (SizeValueType offset = begin; offset < end; ++offset)
+    {
+      const unsigned char status = m_Status[offset].load(std::memory_order_relaxed);
+      if (status >= ProposedBy)
+      {
+        continue;
+      }
+
+      double * count = labelSums + status * stride;
+      double * sum = count + 1;
+      double * products = sum + dimension;
+
+      const InputImagePixelType & pixel = input[offset];
+      for (unsigned int i = 0; i < dimension; ++i)
+      {
+        const auto valueI = static_cast<double>(pixel[i]);
+        products[i * dimension + i] += valueI * valueI;
+        sum[i] += valueI;
+        for (unsigned int j = i + 1; j < dimension; ++j)
+        {
+          const double product = valueI * static_cast<double>(pixel[j]);
+          products[i * dimension + j] += product;
+          products[j * dimension + i] += product;
+        }
+      }
+      *count += 1.0;
+    }
+  });
+
+  sums.assign(labelsStride, 0.0);
+  for (SizeValueType block = 0; block < numberOfBlocks; ++block)
+  {
+    for (SizeValueType k = 0; k < labelsStride; ++k)
+    {
+      sums[k] += blockSums[block * labelsStride + k];
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+MultiLabelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                                   Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfLabels: " << this->GetNumberOfLabels() << std::endl;
+  for (unsigned int label = 0; label < this->GetNumberOfLabels(); ++label)
+  {
+    os << indent << "Label " << label + 1 << ": " << m_SeedSets[label].size()
+       << " seeds, multiplier " << m_Multipliers[label] << std::endl;
+  }
+  os << indent << "NumberOfIterations: " << m_NumberOfIterations << std::endl;
+  os << indent << "InitialNeighborhoodRadius: " << m_InitialNeighborhoodRadius << std::endl;
+  os << indent << "ElapsedIterations: " << m_ElapsedIterations << std::endl;
+}
+
+} // end namespace itk
+
+#endif
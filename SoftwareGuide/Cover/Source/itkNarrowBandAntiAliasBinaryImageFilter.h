@@ -0,0 +1,215 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkNarrowBandAntiAliasBinaryImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkNarrowBandAntiAliasBinaryImageFilter_h
+#define itkNarrowBandAntiAliasBinaryImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkNumericTraits.h"
+#include "itkSparseBandLevelSet.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class NarrowBandAntiAliasBinaryImageFilter
+ * \brief AntiAliasBinaryImageFilter restricted to a fixed narrow band and
+ * run in parallel.
+ *
+ * The level set is positive on the pixels equal to ForegroundValue and
+ * negative elsewhere, and evolves by mean curvature flow under the same
+ * constraint as AntiAliasBinaryImageFilter: no pixel changes sign. The
+ * zero set therefore never leaves the pixels next to the binary surface,
+ * and the band of the pixels within NumberOfLayers city-block steps of the
+ * other class never needs rebuilding. The level set starts at the layer
+ * number minus one half on the band, and is OutsideValue, one half more
+ * than the last layer, everywhere else.
+ *
+ * Only the blocks of BlockEdge pixels per dimension that meet the band are
+ * stored. Every iteration computes the update of all band pixels from the
+ * previous values, in chunks processed in parallel, and the RMS change over
+ * the pixels of the zero layer decides, as in AntiAliasBinaryImageFilter,
+ * whether MaximumRMSError is reached. The chunks are fixed, so the result
+ * does not depend on the number of work units.
+ *
+ * With UseSparseOutput off the full level set is written to the output
+ * image. With it on the output image is left empty, and only the band
+ * values are kept, in GetSparseOutput(), with the sign off the band given
+ * by the input.
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT NarrowBandAntiAliasBinaryImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(NarrowBandAntiAliasBinaryImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = NarrowBandAntiAliasBinaryImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(NarrowBandAntiAliasBinaryImageFilter);
+
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  using InputImageType = TInputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+  using InputImageRegionType = typename InputImageType::RegionType;
+  using IndexType = typename InputImageType::IndexType;
+
+  using OutputImageType = TOutputImage;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  using SparseOutputType = SparseBandLevelSet<ImageDimension>;
+  using ValueType = typename SparseOutputType::ValueType;
+
+  /** Pixels along every dimension of a storage block. */
+  static constexpr unsigned int BlockEdge = 8;
+
+  /** Band pixels per chunk of an update pass. */
+  static constexpr SizeValueType PixelsPerChunk = 16384;
+
+  itkSetMacro(ForegroundValue, InputPixelType);
+  itkGetConstMacro(ForegroundValue, InputPixelType);
+
+  itkSetMacro(MaximumRMSError, double);
+  itkGetConstMacro(MaximumRMSError, double);
+
+  itkSetMacro(MaximumIterations, unsigned int);
+  itkGetConstMacro(MaximumIterations, unsigned int);
+
+  /** Layers of the band on either side of the surface. */
+  itkSetClampMacro(NumberOfLayers, unsigned int, 1, BlockEdge - 1);
+  itkGetConstMacro(NumberOfLayers, unsigned int);
+
+  itkSetMacro(TimeStep, double);
+  itkGetConstMacro(TimeStep, double);
+
+  /** Keep the band only, rather than writing the output image. */
+  itkSetMacro(UseSparseOutput, bool);
+  itkGetConstMacro(UseSparseOutput, bool);
+  itkBooleanMacro(UseSparseOutput);
+
+  itkGetConstMacro(ElapsedIterations, unsigned int);
+  itkGetConstMacro(RMSChange, double);
+
+  /** Band values of the last update with UseSparseOutput on. */
+  const SparseOutputType *
+  GetSparseOutput() const
+  {
+    return m_SparseOutput;
+  }
+
+protected:
+  NarrowBandAntiAliasBinaryImageFilter();
+  ~NarrowBandAntiAliasBinaryImageFilter() override = default;
+
+  /** The band depends on the surface anywhere in the image. */
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  static constexpr SizeValueType NoSlot = NumericTraits<SizeValueType>::max();
+
+  /** Set up the block grid and give a slot to every block within
+   * NumberOfLayers pixels of a pixel next to the other class. */
+  void
+  AllocateBlocks();
+
+  /** Initial level set of the blocks, and the band pixels, as indices into
+   * the block values. */
+  void
+  InitializeBlocks();
+
+  /** Run the curvature flow on the band until it converges. */
+  void
+  Evolve();
+
+  /** Whether a pixel, relative to the region start, is foreground. */
+  bool
+  IsForeground(const IndexType & index) const;
+
+  /** Level set at a pixel, relative to the region start. Indices past the
+   * image are clamped to its border. */
+  ValueType
+  GetValue(IndexType index) const;
+
+  /** Index relative to the region start of a value of a block. */
+  IndexType
+  GetBlockValueIndex(SizeValueType value) const;
+
+  /** Change of the level set at a band pixel per unit of time. */
+  ValueType
+  ComputeUpdate(const IndexType & index) const;
+
+  void
+  WriteDenseOutput();
+
+  void
+  WriteSparseOutput();
+
+  InputPixelType m_ForegroundValue{};
+  double         m_MaximumRMSError{ 0.07 };
+  unsigned int   m_MaximumIterations{ 1000 };
+  unsigned int   m_NumberOfLayers{ ImageDimension };
+  double         m_TimeStep{ 0.05 };
+  bool           m_UseSparseOutput{ false };
+  unsigned int   m_ElapsedIterations{ 0 };
+  double         m_RMSChange{ 0.0 };
+
+  typename SparseOutputType::Pointer m_SparseOutput;
+
+  /** Geometry of the input buffer while the filter runs. */
+  const InputPixelType * m_InputBuffer{ nullptr };
+  SizeValueType          m_Size[ImageDimension]{};
+  SizeValueType          m_Stride[ImageDimension]{};
+  double                 m_Scale[ImageDimension]{};
+  ValueType              m_OutsideValue{};
+
+  /** Block grid, the slot of every block or NoSlot, the block of every
+   * slot, the values of the slots, m_BlockVolume each, and the band. */
+  SizeValueType              m_BlockVolume{ 1 };
+  SizeValueType              m_GridSize[ImageDimension]{};
+  SizeValueType              m_GridStride[ImageDimension]{};
+  std::vector<SizeValueType> m_BlockSlots;
+  std::vector<SizeValueType> m_SlotBlocks;
+  std::vector<ValueType>     m_Values;
+  std::vector<SizeValueType> m_Band;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkNarrowBandAntiAliasBinaryImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,657 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkNarrowBandAntiAliasBinaryImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkNarrowBandAntiAliasBinaryImageFilter_hxx
+#define itkNarrowBandAntiAliasBinaryImageFilter_hxx
+
+#include "itkMultiThreaderBase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::NarrowBandAntiAliasBinaryImageFilter()
+{
+  m_ForegroundValue = NumericTraits<InputPixelType>::max();
+  m_SparseOutput = SparseOutputType::New();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  if (this->GetInput())
+  {
+    auto * input = const_cast<InputImageType *>(this->GetInput());
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  const InputImageType *     input = this->GetInput();
+  const InputImageRegionType region = input->GetBufferedRegion();
+
+  this->GetMultiThreader()->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  m_InputBuffer = input->GetBufferPointer();
+  SizeValueType stride = 1;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    m_Size[d] = region.GetSize(d);
+    m_Stride[d] = stride;
+    m_Scale[d] = 1.0 / input->GetSpacing()[d];
+    stride *= m_Size[d];
+  }
+  m_OutsideValue = static_cast<ValueType>(m_NumberOfLayers) + ValueType{ 0.5 };
+
+  m_ElapsedIterations = 0;
+  m_RMSChange = 0.0;
+
+  if (region.GetNumberOfPixels() > 0)
+  {
+    this->AllocateBlocks();
+    this->InitializeBlocks();
+    this->Evolve();
+  }
+
+  if (m_UseSparseOutput)
+  {
+    this->WriteSparseOutput();
+  }
+  else
+  {
+    this->WriteDenseOutput();
+  }
+
+  m_BlockSlots = std::vector<SizeValueType>();
+  m_SlotBlocks = std::vector<SizeValueType>();
+  m_Values = std::vector<ValueType>();
+  m_Band = std::vector<SizeValueType>();
+  m_InputBuffer = nullptr;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::AllocateBlocks()
+{
+  constexpr unsigned int SlowDimension = ImageDimension - 1;
+
+  SizeValueType numberOfBlocks = 1;
+  m_BlockVolume = 1;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    m_GridSize[d] = (m_Size[d] + BlockEdge - 1) / BlockEdge;
+    m_GridStride[d] = numberOfBlocks;
+    numberOfBlocks *= m_GridSize[d];
+    m_BlockVolume *= BlockEdge;
+  }
+
+  std::unique_ptr<std::atomic<unsigned char>[]> marked(new std::atomic<unsigned char>[numberOfBlocks]);
+  for (SizeValueType block = 0; block < numberOfBlocks; ++block)
+  {
+    marked[block].store(0, std::memory_order_relaxed);
+  }
+
+  // Mark every block within the band reach of a pixel next to the other
+  // class.
+  const IndexValueType layers = m_NumberOfLayers;
+  const auto           markAround = [&](const IndexType & index) {
+    IndexValueType lower[ImageDimension];
+    IndexValueType upper[ImageDimension];
+    IndexValueType grid[ImageDimension];
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      lower[d] = std::max<IndexValueType>(index[d] - layers, 0) / BlockEdge;
+      upper[d] = std::min<IndexValueType>(index[d] + layers, static_cast<IndexValueType>(m_Size[d]) - 1) / BlockEdge;
+      grid[d] = lower[d];
+    }
+    while (true)
+    {
+      SizeValueType block = 0;
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        block += static_cast<SizeValueType>(grid[d]) * m_GridStride[d];
+      }
+      marked[block].store(1, std::memory_order_relaxed);
+
+      unsigned int d = 0;
+      while (d < ImageDimension && grid[d] == upper[d])
+      {
+        grid[d] = lower[d];
+        ++d;
+      }
+      if (d == ImageDimension)
+      {
+        break;
+      }
+      ++grid[d];
+    }
+  };
+
+  const SizeValueType length = m_Size[0];
+  const SizeValueType numberOfSlices = ImageDimension > 1 ? m_Size[SlowDimension] : 1;
+  const SizeValueType linesPerSlice = m_Stride[SlowDimension] * m_Size[SlowDimension] / length / numberOfSlices;
+
+  this->GetMultiThreader()->ParallelizeArray(
+    0,
+    numberOfSlices,
+    [&](SizeValueType slice) {
+      for (SizeValueType line = slice * linesPerSlice; line < (slice + 1) * linesPerSlice; ++line)
+      {
+        IndexType     index;
+        SizeValueType rest = line;
+        for (unsigned int d = 1; d < ImageDimension; ++d)
+        {
+          index[d] = static_cast<IndexValueType>(rest % m_Size[d]);
+          rest /= m_Size[d];
+        }
+
+        const InputPixelType * pixels = m_InputBuffer + line * length;
+        for (SizeValueType x = 0; x < length; ++x)
+        {
+          index[0] = static_cast<IndexValueType>(x);
+          const bool foreground = pixels[x] == m_ForegroundValue;
+
+          // Each pair of neighbours is looked at from its first pixel.
+          for (unsigned int d = 0; d < ImageDimension; ++d)
+          {
+            if (static_cast<SizeValueType>(index[d]) + 1 < m_Size[d] &&
+                (pixels[x + m_Stride[d]] == m_ForegroundValue) != foreground)
+            {
+              IndexType next = index;
+              ++next[d];
+              markAround(index);
+              markAround(next);
+            }
+          }
+        }
+      }
+    },
+    nullptr);
+
+  // Slots in block order, so that the layout does not depend on the
+  // threads.
+  m_BlockSlots.assign(numberOfBlocks, NoSlot);
+  m_SlotBlocks.clear();
+  for (SizeValueType block = 0; block < numberOfBlocks; ++block)
+  {
+    if (marked[block].load(std::memory_order_relaxed))
+    {
+      m_BlockSlots[block] = m_SlotBlocks.size();
+      m_SlotBlocks.push_back(block);
+    }
+  }
+  m_Values.assign(m_SlotBlocks.size() * m_BlockVolume, ValueType{});
+
+  itkDebugMacro(<< m_SlotBlocks.size() << " of " << numberOfBlocks << " blocks meet the band");
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::InitializeBlocks()
+{
+  const SizeValueType numberOfSlots = m_SlotBlocks.size();
+  const SizeValueType slotsPerChunk = std::max<SizeValueType>(1, PixelsPerChunk / m_BlockVolume);
+  const SizeValueType numberOfChunks = (numberOfSlots + slotsPerChunk - 1) / slotsPerChunk;
+  const IndexValueType layers = m_NumberOfLayers;
+
+  std::vector<std::vector<SizeValueType>> chunkBands(numberOfChunks);
+
+  this->GetMultiThreader()->ParallelizeArray(
+    0,
+    numberOfChunks,
+    [&](SizeValueType chunk) {
+      // City-block distances to the nearest background and foreground pixel
+      // over the block and a margin of NumberOfLayers pixels, clamped past
+      // the band.
+      std::vector<IndexValueType> toBackground;
+      std::vector<IndexValueType> toForeground;
+      std::vector<SizeValueType>  band;
+
+      const SizeValueType lastSlot = std::min(numberOfSlots, (chunk + 1) * slotsPerChunk);
+      for (SizeValueType slot = chunk * slotsPerChunk; slot < lastSlot; ++slot)
+      {
+        const IndexType first = this->GetBlockValueIndex(slot * m_BlockVolume);
+
+        IndexValueType lower[ImageDimension];
+        IndexValueType extent[ImageDimension];
+        SizeValueType  haloStride[ImageDimension];
+        SizeValueType  haloVolume = 1;
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          const auto size = static_cast<IndexValueType>(m_Size[d]);
+          lower[d] = std::max<IndexValueType>(first[d] - layers, 0);
+          extent[d] = std::min<IndexValueType>(first[d] + BlockEdge + layers, size) - lower[d];
+          haloStride[d] = haloVolume;
+          haloVolume *= static_cast<SizeValueType>(extent[d]);
+        }
+
+        toBackground.resize(haloVolume);
+        toForeground.resize(haloVolume);
+
+        IndexValueType position[ImageDimension];
+        std::fill(position, position + ImageDimension, 0);
+        for (SizeValueType h = 0; h < haloVolume; ++h)
+        {
+          IndexType index;
+          for (unsigned int d = 0; d < ImageDimension; ++d)
+          {
+            index[d] = lower[d] + position[d];
+          }
+          const bool foreground = this->IsForeground(index);
+          toBackground[h] = foreground ? layers + 1 : 0;
+          toForeground[h] = foreground ? 0 : layers + 1;
+
+          for (unsigned int d = 0; d < ImageDimension; ++d)
+          {
+            if (position[d] > 0)
+            {
+              toBackground[h] = std::min(toBackground[h], toBackground[h - haloStride[d]] + 1);
+              toForeground[h] = std::min(toForeground[h], toForeground[h - haloStride[d]] + 1);
+            }
+          }
+
+          unsigned int d = 0;
+          while (d < ImageDimension && ++position[d] == extent[d])
+          {
+            position[d++] = 0;
+          }
+        }
+
+        for (SizeValueType h = haloVolume; h-- > 0;)
+        {
+          SizeValueType rest = h;
+          for (unsigned int d = 0; d < ImageDimension; ++d)
+          {
+            const auto p = static_cast<IndexValueType>(rest % static_cast<SizeValueType>(extent[d]));
+            rest /= static_cast<SizeValueType>(extent[d]);
+            if (p + 1 < extent[d])
+            {
+              toBackground[h] = std::min(toBackground[h], toBackground[h + haloStride[d]] + 1);
+              toForeground[h] = std::min(toForeground[h], toForeground[h + haloStride[d]] + 1);
+            }
+          }
+        }
+
+        for (SizeValueType local = 0; local < m_BlockVolume; ++local)
+        {
+          const SizeValueType value = slot * m_BlockVolume + local;
+          const IndexType     index = this->GetBlockValueIndex(value);
+
+          SizeValueType h = 0;
+          bool          inside = true;
+          for (unsigned int d = 0; d < ImageDimension; ++d)
+          {
+            inside = inside && static_cast<SizeValueType>(index[d]) < m_Size[d];
+            h += static_cast<SizeValueType>(index[d] - lower[d]) * haloStride[d];
+          }
+          if (!inside)
+          {
+            continue;
+          }
+
+          const bool           foreground = this->IsForeground(index);
+          const IndexValueType layer = foreground ? toBackground[h] : toForeground[h];
+          const auto           magnitude = static_cast<ValueType>(std::min(layer, layers + 1)) - ValueType{ 0.5 };
+          m_Values[value] = foreground ? magnitude : -magnitude;
+          if (layer <= layers)
+          {
+            band.push_back(value);
+          }
+        }
+      }
+
+      chunkBands[chunk].swap(band);
+    },
+    nullptr);
+
+  m_Band.clear();
+  for (const auto & band : chunkBands)
+  {
+    m_Band.insert(m_Band.end(), band.cbegin(), band.cend());
+  }
+
+  itkDebugMacro(<< m_Band.size() << " pixels in the band");
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::Evolve()
+{
+  const SizeValueType numberOfPixels = m_Band.size();
+  const SizeValueType numberOfChunks = (numberOfPixels + PixelsPerChunk - 1) / PixelsPerChunk;
+  const auto          timeStep = static_cast<ValueType>(m_TimeStep);
+
+  std::vector<ValueType>     updated(numberOfPixels);
+  std::vector<double>        chunkChanges(numberOfChunks);
+  std::vector<SizeValueType> chunkCounts(numberOfChunks);
+
+  while (m_ElapsedIterations < m_MaximumIterations)
+  {
+    this->GetMultiThreader()->ParallelizeArray(
+      0,
+      numberOfChunks,
+      [&](SizeValueType chunk) {
+        double        change = 0.0;
+        SizeValueType count = 0;
+
+        const SizeValueType last = std::min(numberOfPixels, (chunk + 1) * PixelsPerChunk);
+        for (SizeValueType n = chunk * PixelsPerChunk; n < last; ++n)
+        {
+          const IndexType index = this->GetBlockValueIndex(m_Band[n]);
+          const ValueType previous = m_Values[m_Band[n]];
+
+          // The sign of the input is kept, as in AntiAliasBinaryImageFilter.
+          ValueType value = previous + timeStep * this->ComputeUpdate(index);
+          value = this->IsForeground(index) ? std::max(value, ValueType{}) : std::min(value, ValueType{});
+          updated[n] = value;
+
+          if (std::abs(previous) <= ValueType{ 0.5 })
+          {
+            change += static_cast<double>(value - previous) * static_cast<double>(value - previous);
+            ++count;
+          }
+        }
+
+        chunkChanges[chunk] = change;
+        chunkCounts[chunk] = count;
+      },
+      nullptr);
+
+    this->GetMultiThreader()->ParallelizeArray(
+      0,
+      numberOfChunks,
+      [&](SizeValueType chunk) {
+        const SizeValueType last = std::min(numberOfPixels, (chunk + 1) * PixelsPerChunk);
+        for (SizeValueType n = chunk * PixelsPerChunk; n < last; ++n)
+        {
+          m_Values[m_Band[n]] = updated[n];
+        }
+      },
+      nullptr);
+
+    double        change = 0.0;
+    SizeValueType count = 0;
+    for (SizeValueType chunk = 0; chunk < numberOfChunks; ++chunk)
+    {
+      change += chunkChanges[chunk];
+      count += chunkCounts[chunk];
+    }
+    m_RMSChange = count > 0 ? std::sqrt(change / static_cast<double>(count)) : 0.0;
+    ++m_ElapsedIterations;
+
+    if (m_RMSChange < m_MaximumRMSError)
+    {
+      break;
+    }
+  }
+
+  itkDebugMacro(<< "Stopped after " << m_ElapsedIterations << " iterations with an RMS change of " << m_RMSChange);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+bool
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::IsForeground(const IndexType & index) const
+{
+  SizeValueType offset = 0;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    offset += static_cast<SizeValueType>(index[d]) * m_Stride[d];
+  }
+  return m_InputBuffer[offset] == m_ForegroundValue;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::GetValue(IndexType index) const -> ValueType
+{
+  SizeValueType block = 0;
+  SizeValueType local = 0;
+  SizeValueType localStride = 1;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    index[d] = std::min(std::max<IndexValueType>(index[d], 0), static_cast<IndexValueType>(m_Size[d]) - 1);
+    block += static_cast<SizeValueType>(index[d]) / BlockEdge * m_GridStride[d];
+    local += static_cast<SizeValueType>(index[d]) % BlockEdge * localStride;
+    localStride *= BlockEdge;
+  }
+
+  const SizeValueType slot = m_BlockSlots[block];
+  if (slot == NoSlot)
+  {
+    return this->IsForeground(index) ? m_OutsideValue : -m_OutsideValue;
+  }
+  return m_Values[slot * m_BlockVolume + local];
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::GetBlockValueIndex(SizeValueType value) const
+  -> IndexType
+{
+  SizeValueType block = m_SlotBlocks[value / m_BlockVolume];
+  SizeValueType local = value % m_BlockVolume;
+
+  IndexType index;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    index[d] = static_cast<IndexValueType>(block % m_GridSize[d] * BlockEdge + local % BlockEdge);
+    block /= m_GridSize[d];
+    local /= BlockEdge;
+  }
+  return index;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::ComputeUpdate(const IndexType & index) const
+  -> ValueType
+{
+  // Mean curvature times the gradient magnitude from central differences,
+  // as computed by CurvatureFlowFunction.
+  const double center = this->GetValue(index);
+
+  double first[ImageDimension];
+  double second[ImageDimension];
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    IndexType neighbor = index;
+    ++neighbor[i];
+    const double plus = this->GetValue(neighbor);
+    neighbor[i] -= 2;
+    const double minus = this->GetValue(neighbor);
+
+    first[i] = 0.5 * (plus - minus) * m_Scale[i];
+    second[i] = (plus - 2.0 * center + minus) * m_Scale[i] * m_Scale[i];
+  }
+
+  double magnitudeSquared = 0.0;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    magnitudeSquared += first[i] * first[i];
+  }
+  if (magnitudeSquared < 1e-9)
+  {
+    return ValueType{};
+  }
+
+  double update = 0.0;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    double others = 0.0;
+    for (unsigned int j = 0; j < ImageDimension; ++j)
+    {
+      if (j != i)
+      {
+        others += second[j];
+      }
+    }
+    update += others * first[i] * first[i];
+  }
+
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    for (unsigned int j = i + 1; j < ImageDimension; ++j)
+    {
+      IndexType neighbor = index;
+      ++neighbor[i];
+      ++neighbor[j];
+      double cross = this->GetValue(neighbor);
+      neighbor[j] -= 2;
+      cross -= this->GetValue(neighbor);
+      neighbor[i] -= 2;
+      cross += this->GetValue(neighbor);
+      neighbor[j] += 2;
+      cross -= this->GetValue(neighbor);
+
+      update -= 2.0 * first[i] * first[j] * 0.25 * cross * m_Scale[i] * m_Scale[j];
+    }
+  }
+
+  return static_cast<ValueType>(update / magnitudeSquared);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::WriteDenseOutput()
+{
+  constexpr unsigned int SlowDimension = ImageDimension - 1;
+
+  OutputImageType * output = this->GetOutput();
+  output->SetBufferedRegion(output->GetRequestedRegion());
+  output->Allocate();
+
+  const SizeValueType numberOfPixels = output->GetBufferedRegion().GetNumberOfPixels();
+  if (numberOfPixels == 0)
+  {
+    return;
+  }
+
+  OutputPixelType *   buffer = output->GetBufferPointer();
+  const SizeValueType length = m_Size[0];
+  const SizeValueType numberOfSlices = ImageDimension > 1 ? m_Size[SlowDimension] : 1;
+  const SizeValueType linesPerSlice = numberOfPixels / length / numberOfSlices;
+
+  this->GetMultiThreader()->ParallelizeArray(
+    0,
+    numberOfSlices,
+    [&](SizeValueType slice) {
+      for (SizeValueType line = slice * linesPerSlice; line < (slice + 1) * linesPerSlice; ++line)
+      {
+        IndexType     index;
+        SizeValueType rest = line;
+        for (unsigned int d = 1; d < ImageDimension; ++d)
+        {
+          index[d] = static_cast<IndexValueType>(rest % m_Size[d]);
+          rest /= m_Size[d];
+        }
+
+        OutputPixelType * pixels = buffer + line * length;
+        for (SizeValueType x = 0; x < length; ++x)
+        {
+          index[0] = static_cast<IndexValueType>(x);
+          pixels[x] = static_cast<OutputPixelType>(this->GetValue(index));
+        }
+      }
+    },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::WriteSparseOutput()
+{
+  typename SparseOutputType::EntryContainerType entries(m_Band.size());
+
+  const SizeValueType numberOfPixels = m_Band.size();
+  const SizeValueType numberOfChunks = (numberOfPixels + PixelsPerChunk - 1) / PixelsPerChunk;
+
+  this->GetMultiThreader()->ParallelizeArray(
+    0,
+    numberOfChunks,
+    [&](SizeValueType chunk) {
+      const SizeValueType last = std::min(numberOfPixels, (chunk + 1) * PixelsPerChunk);
+      for (SizeValueType n = chunk * PixelsPerChunk; n < last; ++n)
+      {
+        const IndexType index = this->GetBlockValueIndex(m_Band[n]);
+        SizeValueType   offset = 0;
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          offset += static_cast<SizeValueType>(index[d]) * m_Stride[d];
+        }
+        entries[n] = { offset, m_Values[m_Band[n]] };
+      }
+    },
+    nullptr);
+
+  std::sort(entries.begin(), entries.end(), [](const auto & a, const auto & b) { return a.first < b.first; });
+
+  m_SparseOutput->CopyInformation(this->GetInput());
+  m_SparseOutput->SetOutsideValue(m_OutsideValue);
+  m_SparseOutput->SetEntries(std::move(entries));
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+NarrowBandAntiAliasBinaryImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "ForegroundValue: " << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_ForegroundValue)
+     << std::endl;
+  os << indent << "MaximumRMSError: " << m_MaximumRMSError << std::endl;
+  os << indent << "MaximumIterations: " << m_MaximumIterations << std::endl;
+  os << indent << "NumberOfLayers: " << m_NumberOfLayers << std::endl;
+  os << indent << "TimeStep: " << m_TimeStep << std::endl;
+  os << indent << "UseSparseOutput: " << (m_UseSparseOutput ? "On" : "Off") << std::endl;
+  os << indent << "ElapsedIterations: " << m_ElapsedIterations << std::endl;
+  os << indent << "RMSChange: " << m_RMSChange << std::endl;
+}
+
+} // end namespace itk
+
+#endif
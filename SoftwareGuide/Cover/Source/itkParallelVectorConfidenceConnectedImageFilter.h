@@ -0,0 +1,249 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelVectorConfidenceConnectedImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkParallelVectorConfidenceConnectedImageFilter_h
+#define itkParallelVectorConfidenceConnectedImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkMahalanobisDistanceThresholdImageFunction.h"
+#include "itkNumericTraits.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace itk
+{
+
+/** \class ParallelVectorConfidenceConnectedImageFilter
+ * \brief VectorConfidenceConnectedImageFilter with a multithreaded region
+ * growing engine.
+ *
+ * The algorithm is the one of VectorConfidenceConnectedImageFilter: the
+ * initial mean and covariance are taken from the neighbourhoods of the
+ * seeds, the region connected to the seeds whose Mahalanobis distance is
+ * at most Multiplier is grown, and then NumberOfIterations times the
+ * statistics are recomputed over the region and the region is regrown.
+ *
+ * The region is grown breadth first in level-synchronous waves. Every wave
+ * cuts the frontier into fixed chunks that are expanded concurrently, each
+ * into its own queue, and the queues are concatenated into the next
+ * frontier. A byte per pixel records whether it is unvisited, rejected or
+ * accepted; a pixel is claimed with a compare-and-swap, so each one is
+ * tested exactly once. The grown region is the face-connected component of
+ * the accepted pixels that holds the seeds, which does not depend on the
+ * visiting order, so the output is identical to the serial flood fill.
+ *
+ * Most pixels stay in the region from one iteration to the next. With
+ * UseIncrementalStatistics on, the filter keeps the running sums of the
+ * components and of their products over the region. Every regrowing only
+ * adds the pixels that joined the region and subtracts the ones that left
+ * it, instead of summing over the whole region again. Only the pixels
+ * claimed by the last regrowing are reset before the next one, so an
+ * iteration costs time in proportion to the region and its boundary, not
+ * to the image. The running sums are exact for integer components, so the
+ * mean and covariance match the original filter bit for bit. For
+ * floating-point components the sums are recomputed block by block in
+ * buffer order instead, and they may differ from the original filter in
+ * the last bits.
+ *
+ * When a regrowing gives back the region the statistics were taken from,
+ * every further iteration would reproduce it. The loop stops there, and
+ * ElapsedIterations reports how many iterations were run.
+ *
+ * Like the original filter, the threshold is raised to the largest
+ * initial distance of the seeds, so the seeds are always included. The
+ * Multiplier setting itself is left unchanged.
+ *
+ * The input must be an Image of fixed-length vector pixels whose buffer
+ * covers the largest possible region.
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT ParallelVectorConfidenceConnectedImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(ParallelVectorConfidenceConnectedImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = ParallelVectorConfidenceConnectedImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(ParallelVectorConfidenceConnectedImageFilter);
+
+  using InputImageType = TInputImage;
+  using InputImagePixelType = typename InputImageType::PixelType;
+  using IndexType = typename InputImageType::IndexType;
+
+  using OutputImageType = TOutputImage;
+  using OutputImagePixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  using ComponentType = typename NumericTraits<InputImagePixelType>::ValueType;
+
+  using SeedsContainerType = std::vector<IndexType>;
+
+  using DistanceThresholdFunctionType = MahalanobisDistanceThresholdImageFunction<InputImageType>;
+  using CovarianceMatrixType = typename DistanceThresholdFunctionType::CovarianceMatrixType;
+  using MeanVectorType = typename DistanceThresholdFunctionType::MeanVectorType;
+
+  /** Pixels per block of the buffer-order passes, and frontier entries per
+   * chunk of a growing wave. Both are fixed so that the work split does not
+   * depend on the number of threads. */
+  static constexpr SizeValueType PixelsPerBlock = 65536;
+  static constexpr SizeValueType FrontierChunkSize = 1024;
+
+  /** Set a single seed point, discarding the others. */
+  void
+  SetSeed(const IndexType & seed);
+
+  /** Add a seed point. */
+  void
+  AddSeed(const IndexType & seed);
+
+  /** Remove all seed points. */
+  void
+  ClearSeeds();
+
+  /** Seed points, in the order they were added. */
+  const SeedsContainerType &
+  GetSeeds() const
+  {
+    return m_Seeds;
+  }
+
+  /** Largest Mahalanobis distance accepted in the region. */
+  itkSetMacro(Multiplier, double);
+  itkGetConstMacro(Multiplier, double);
+
+  /** Number of times the statistics are recomputed and the region regrown. */
+  itkSetMacro(NumberOfIterations, unsigned int);
+  itkGetConstMacro(NumberOfIterations, unsigned int);
+
+  /** Value written on the region, the rest of the output is zero. */
+  itkSetMacro(ReplaceValue, OutputImagePixelType);
+  itkGetConstMacro(ReplaceValue, OutputImagePixelType);
+
+  /** Radius of the neighbourhoods the initial statistics are taken from. */
+  itkSetMacro(InitialNeighborhoodRadius, unsigned int);
+  itkGetConstReferenceMacro(InitialNeighborhoodRadius, unsigned int);
+
+  /** Update the region statistics from the pixels that joined or left the
+   * region. Only used for integer components. On by default. */
+  itkSetMacro(UseIncrementalStatistics, bool);
+  itkGetConstMacro(UseIncrementalStatistics, bool);
+  itkBooleanMacro(UseIncrementalStatistics);
+
+  /** Number of iterations run by the last update. Lower than
+   * NumberOfIterations when the region stopped changing. */
+  itkGetConstMacro(ElapsedIterations, unsigned int);
+
+  /** Statistics used by the last regrowing of the region. */
+  const MeanVectorType &
+  GetMean() const;
+
+  const CovarianceMatrixType &
+  GetCovariance() const;
+
+protected:
+  ParallelVectorConfidenceConnectedImageFilter();
+  ~ParallelVectorConfidenceConnectedImageFilter() override = default;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  using StatusType = std::atomic<unsigned char>;
+  using FrontierType = std::vector<IndexType>;
+
+  /** A pixel is unvisited, rejected or accepted, plus a flag telling
+   * whether it belonged to the region before the current regrowing. */
+  enum : unsigned char
+  {
+    Unvisited = 0,
+    Rejected = 1,
+    Accepted = 2,
+    InPreviousRegion = 4
+  };
+
+  /** Run function(block, begin, end) over fixed blocks of [0, numberOfElements). */
+  void
+  ParallelizeBlocks(SizeValueType                                                            numberOfElements,
+                    const std::function<void(SizeValueType, SizeValueType, SizeValueType)> & function) const;
+
+  /** Claim a pixel and test it against the threshold function. Returns its
+   * new status, or Unvisited when another thread claimed it first. */
+  unsigned char
+  TestPixel(const IndexType & index, OffsetValueType offset);
+
+  /** Grow the region from the seeds with the current statistics, and
+   * update the running sums with the pixels that joined or left it.
+   * Returns true when the region changed. */
+  bool
+  GrowRegion();
+
+  /** Add the count, components and component products of a pixel. */
+  static void
+  AccumulatePixel(const InputImagePixelType & pixel, unsigned int dimension, double * sums);
+
+  /** Recompute the running sums over the whole region. */
+  void
+  ComputeRegionSums();
+
+  /** Mean and covariance from the running sums. */
+  void
+  ComputeStatisticsFromSums(MeanVectorType & mean, CovarianceMatrixType & covariance) const;
+
+  SeedsContainerType m_Seeds;
+
+  double               m_Multiplier{ 2.5 };
+  unsigned int         m_NumberOfIterations{ 4 };
+  OutputImagePixelType m_ReplaceValue{};
+  unsigned int         m_InitialNeighborhoodRadius{ 1 };
+  bool                 m_UseIncrementalStatistics{ true };
+  unsigned int         m_ElapsedIterations{ 0 };
+
+  typename DistanceThresholdFunctionType::Pointer m_ThresholdFunction;
+
+  std::unique_ptr<StatusType[]> m_Status;
+  std::vector<OffsetValueType>  m_RegionPixels;
+  std::vector<OffsetValueType>  m_BoundaryPixels;
+  std::vector<double>           m_RegionSums;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkParallelVectorConfidenceConnectedImageFilter.hxx"
+#endif
+
+#endif
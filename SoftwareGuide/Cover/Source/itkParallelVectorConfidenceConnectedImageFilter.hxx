@@ -0,0 +1,561 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelVectorConfidenceConnectedImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkParallelVectorConfidenceConnectedImageFilter_hxx
+#define itkParallelVectorConfidenceConnectedImageFilter_hxx
+
+#include "itkCovarianceImageFunction.h"
+#include "itkMultiThreaderBase.h"
+#include "itkNumericTraits.h"
+#include "itkVectorMeanImageFunction.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::ParallelVectorConfidenceConnectedImageFilter()
+{
+  m_ReplaceValue = NumericTraits<OutputImagePixelType>::OneValue();
+  m_ThresholdFunction = DistanceThresholdFunctionType::New();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::SetSeed(const IndexType & seed)
+{
+  m_Seeds.clear();
+  this->AddSeed(seed);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::AddSeed(const IndexType & seed)
+{
+  m_Seeds.push_back(seed);
+  this->Modified();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::ClearSeeds()
+{
+  if (!m_Seeds.empty())
+  {
+    m_Seeds.clear();
+    this->Modified();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::GetMean() const -> const MeanVectorType &
+{
+  return m_ThresholdFunction->GetMean();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::GetCovariance() const
+  -> const CovarianceMatrixType &
+{
+  return m_ThresholdFunction->GetCovariance();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  if (this->GetInput())
+  {
+    auto * input = const_cast<InputImageType *>(this->GetInput());
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(
+  DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  const InputImageType * inputImage = this->GetInput();
+  OutputImageType *      outputImage = this->GetOutput();
+
+  const OutputImageRegionType region = outputImage->GetRequestedRegion();
+  outputImage->SetBufferedRegion(region);
+  outputImage->Allocate();
+
+  this->GetMultiThreader()->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  // Initial statistics, the average over the seeds of the mean and the
+  // covariance of their neighbourhoods.
+  auto meanFunction = VectorMeanImageFunction<InputImageType>::New();
+  meanFunction->SetInputImage(inputImage);
+  meanFunction->SetNeighborhoodRadius(m_InitialNeighborhoodRadius);
+
+  auto covarianceFunction = CovarianceImageFunction<InputImageType>::New();
+  covarianceFunction->SetInputImage(inputImage);
+  covarianceFunction->SetNeighborhoodRadius(m_InitialNeighborhoodRadius);
+
+  const unsigned int dimension = inputImage->GetNumberOfComponentsPerPixel();
+
+  MeanVectorType       mean(dimension, 0.0);
+  CovarianceMatrixType covariance(dimension, dimension, 0.0);
+
+  for (const auto & seed : m_Seeds)
+  {
+    const auto meanContribution = meanFunction->EvaluateAtIndex(seed);
+    const auto covarianceContribution = covarianceFunction->EvaluateAtIndex(seed);
+    for (unsigned int i = 0; i < dimension; ++i)
+    {
+      mean[i] += meanContribution[i];
+      for (unsigned int j = 0; j < dimension; ++j)
+      {
+        covariance[i][j] += covarianceContribution[i][j];
+      }
+    }
+  }
+  for (unsigned int i = 0; i < dimension; ++i)
+  {
+    mean[i] /= m_Seeds.size();
+    for (unsigned int j = 0; j < dimension; ++j)
+    {
+      covariance[i][j] /= m_Seeds.size();
+    }
+  }
+
+  m_ThresholdFunction->SetInputImage(inputImage);
+  m_ThresholdFunction->SetMean(mean);
+  m_ThresholdFunction->SetCovariance(covariance);
+
+  double threshold = m_Multiplier;
+  for (const auto & seed : m_Seeds)
+  {
+    threshold = std::max(threshold, m_ThresholdFunction->EvaluateDistanceAtIndex(seed));
+  }
+  m_ThresholdFunction->SetThreshold(threshold);
+
+  itkDebugMacro(<< "Multiplier " << m_Multiplier << ", threshold after seeds inclusion " << threshold);
+
+  // Running sums are exact only when the components are integers.
+  const bool incremental = m_UseIncrementalStatistics && NumericTraits<ComponentType>::is_integer;
+
+  m_Status.reset(new StatusType[region.GetNumberOfPixels()]());
+  m_RegionPixels.clear();
+  m_BoundaryPixels.clear();
+  m_RegionSums.assign(1 + dimension + dimension * dimension, 0.0);
+  m_ElapsedIterations = 0;
+
+  bool regionChanged = this->GrowRegion();
+  this->UpdateProgress(1.0f / (m_NumberOfIterations + 1));
+
+  // Once the region is the one the statistics were taken from, every
+  // further iteration reproduces it.
+  while (m_ElapsedIterations < m_NumberOfIterations && regionChanged)
+  {
+    if (!incremental)
+    {
+      this->ComputeRegionSums();
+    }
+    this->ComputeStatisticsFromSums(mean, covariance);
+
+    m_ThresholdFunction->SetMean(mean);
+    m_ThresholdFunction->SetCovariance(covariance);
+
+    regionChanged = this->GrowRegion();
+    ++m_ElapsedIterations;
+    this->UpdateProgress(static_cast<float>(m_ElapsedIterations + 1) / (m_NumberOfIterations + 1));
+  }
+
+  itkDebugMacro(<< "Region settled after " << m_ElapsedIterations << " of " << m_NumberOfIterations << " iterations");
+
+  OutputImagePixelType *     output = outputImage->GetBufferPointer();
+  const OutputImagePixelType replaceValue = m_ReplaceValue;
+  const OutputImagePixelType zero = NumericTraits<OutputImagePixelType>::ZeroValue();
+
+  this->ParallelizeBlocks(region.GetNumberOfPixels(), [&](SizeValueType, SizeValueType begin, SizeValueType end) {
+    for (SizeValueType offset = begin; offset < end; ++offset)
+    {
+      output[offset] = m_Status[offset].load(std::memory_order_relaxed) == Accepted ? replaceValue : zero;
+    }
+  });
+
+  m_Status.reset();
+  std::vector<OffsetValueType>().swap(m_RegionPixels);
+  std::vector<OffsetValueType>().swap(m_BoundaryPixels);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::ParallelizeBlocks(
+  SizeValueType                                                            numberOfElements,
+  const std::function<void(SizeValueType, SizeValueType, SizeValueType)> & function) const
+{
+  this->GetMultiThreader()->ParallelizeArray(
+    0,
+    (numberOfElements + PixelsPerBlock - 1) / PixelsPerBlock,
+    [&](SizeValueType block) {
+      function(block, block * PixelsPerBlock, std::min(numberOfElements, (block + 1) * PixelsPerBlock));
+    },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+unsigned char
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::TestPixel(const IndexType & index,
+                                                                                 OffsetValueType   offset)
+{
+  StatusType & status = m_Status[offset];
+
+  // The plain load keeps the compare-and-swap off pixels already claimed,
+  // which are most of the neighbours of a frontier.
+  unsigned char previous = status.load(std::memory_order_relaxed);
+  if ((previous & ~InPreviousRegion) != Unvisited ||
+      !status.compare_exchange_strong(previous, previous | Rejected, std::memory_order_relaxed))
+  {
+    return Unvisited;
+  }
+
+  if (!m_ThresholdFunction->EvaluateAtIndex(index))
+  {
+    return previous | Rejected;
+  }
+
+  status.store(previous | Accepted, std::memory_order_relaxed);
+  return previous | Accepted;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+bool
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::GrowRegion()
+{
+  constexpr unsigned int ImageDimension = OutputImageType::ImageDimension;
+
+  const InputImagePixelType * input = this->GetInput()->GetBufferPointer();
+  const OutputImageType *     outputImage = this->GetOutput();
+  const OutputImageRegionType region = outputImage->GetBufferedRegion();
+  const unsigned int          dimension = this->GetInput()->GetNumberOfComponentsPerPixel();
+  const unsigned int          stride = 1 + dimension + dimension * dimension;
+
+  // Only the pixels claimed by the last growing are not unvisited. The
+  // pixels of the region keep a flag, so the ones leaving it can be found.
+  this->ParallelizeBlocks(m_BoundaryPixels.size(), [&](SizeValueType, SizeValueType begin, SizeValueType end) {
+    for (SizeValueType i = begin; i < end; ++i)
+    {
+      m_Status[m_BoundaryPixels[i]].store(Unvisited, std::memory_order_relaxed);
+    }
+  });
+  this->ParallelizeBlocks(m_RegionPixels.size(), [&](SizeValueType, SizeValueType begin, SizeValueType end) {
+    for (SizeValueType i = begin; i < end; ++i)
+    {
+      m_Status[m_RegionPixels[i]].store(InPreviousRegion, std::memory_order_relaxed);
+    }
+  });
+
+  std::vector<OffsetValueType> previousRegion;
+  previousRegion.swap(m_RegionPixels);
+  m_BoundaryPixels.clear();
+
+  std::vector<double> addedSums(stride, 0.0);
+
+  FrontierType frontier;
+  for (const auto & seed : m_Seeds)
+  {
+    if (!region.IsInside(seed))
+    {
+      continue;
+    }
+    const OffsetValueType offset = outputImage->ComputeOffset(seed);
+    const unsigned char   status = this->TestPixel(seed, offset);
+    if (status & Accepted)
+    {
+      frontier.push_back(seed);
+      m_RegionPixels.push_back(offset);
+      if (!(status & InPreviousRegion))
+      {
+        AccumulatePixel(input[offset], dimension, addedSums.data());
+      }
+    }
+    else if (status & Rejected)
+    {
+      m_BoundaryPixels.push_back(offset);
+    }
+  }
+
+  IndexValueType first[ImageDimension];
+  IndexValueType last[ImageDimension];
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    first[d] = region.GetIndex(d);
+    last[d] = first[d] + static_cast<IndexValueType>(region.GetSize(d)) - 1;
+  }
+
+  struct WaveChunk
+  {
+    FrontierType                 Frontier;
+    std::vector<OffsetValueType> Accepted;
+    std::vector<OffsetValueType> Rejected;
+    std::vector<double>          AddedSums;
+  };
+  std::vector<WaveChunk> chunks;
+
+  while (!frontier.empty())
+  {
+    const SizeValueType numberOfChunks = (frontier.size() + FrontierChunkSize - 1) / FrontierChunkSize;
+    chunks.resize(numberOfChunks);
+
+    const auto expandChunk = [&](SizeValueType chunk) {
+      WaveChunk & wave = chunks[chunk];
+      wave.Frontier.clear();
+      wave.Accepted.clear();
+      wave.Rejected.clear();
+      wave.AddedSums.assign(stride, 0.0);
+
+      const auto visit = [&](const IndexType & neighbor) {
+        const OffsetValueType offset = outputImage->ComputeOffset(neighbor);
+        const unsigned char   status = this->TestPixel(neighbor, offset);
+        if (status & Accepted)
+        {
+          wave.Frontier.push_back(neighbor);
+          wave.Accepted.push_back(offset);
+          if (!(status & InPreviousRegion))
+          {
+            AccumulatePixel(input[offset], dimension, wave.AddedSums.data());
+          }
+        }
+        else if (status & Rejected)
+        {
+          wave.Rejected.push_back(offset);
+        }
+      };
+
+      const SizeValueType end = std::min<SizeValueType>(frontier.size(), (chunk + 1) * FrontierChunkSize);
+      for (SizeValueType i = chunk * FrontierChunkSize; i < end; ++i)
+      {
+        const IndexType & index = frontier[i];
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          IndexType neighbor = index;
+          if (index[d] > first[d])
+          {
+            neighbor[d] = index[d] - 1;
+            visit(neighbor);
+          }
+          if (index[d] < last[d])
+          {
+            neighbor[d] = index[d] + 1;
+            visit(neighbor);
+          }
+        }
+      }
+    };
+
+    if (numberOfChunks == 1)
+    {
+      expandChunk(0);
+    }
+    else
+    {
+      this->GetMultiThreader()->ParallelizeArray(0, numberOfChunks, expandChunk, nullptr);
+    }
+
+    frontier.clear();
+    for (SizeValueType chunk = 0; chunk < numberOfChunks; ++chunk)
+    {
+      const WaveChunk & wave = chunks[chunk];
+      frontier.insert(frontier.end(), wave.Frontier.begin(), wave.Frontier.end());
+      m_RegionPixels.insert(m_RegionPixels.end(), wave.Accepted.begin(), wave.Accepted.end());
+      m_BoundaryPixels.insert(m_BoundaryPixels.end(), wave.Rejected.begin(), wave.Rejected.end());
+      for (unsigned int k = 0; k < stride; ++k)
+      {
+        addedSums[k] += wave.AddedSums[k];
+      }
+    }
+  }
+
+  // The pixels of the previous region that were not accepted again have
+  // left it. Their flags are cleared in the same pass.
+  const SizeValueType numberOfBlocks = (previousRegion.size() + PixelsPerBlock - 1) / PixelsPerBlock;
+  std::vector<double> removedSums(numberOfBlocks * stride, 0.0);
+
+  this->ParallelizeBlocks(previousRegion.size(), [&](SizeValueType block, SizeValueType begin, SizeValueType end) {
+    double * sums = removedSums.data() + block * stride;
+    for (SizeValueType i = begin; i < end; ++i)
+    {
+      StatusType &        status = m_Status[previousRegion[i]];
+      const unsigned char value = status.load(std::memory_order_relaxed);
+      if (!(value & Accepted))
+      {
+        AccumulatePixel(input[previousRegion[i]], dimension, sums);
+      }
+      status.store(value & ~InPreviousRegion, std::memory_order_relaxed);
+    }
+  });
+
+  double numberOfRemovedPixels = 0.0;
+  for (unsigned int k = 0; k < stride; ++k)
+  {
+    m_RegionSums[k] += addedSums[k];
+  }
+  for (SizeValueType block = 0; block < numberOfBlocks; ++block)
+  {
+    const double * sums = removedSums.data() + block * stride;
+    numberOfRemovedPixels += sums[0];
+    for (unsigned int k = 0; k < stride; ++k)
+    {
+      m_RegionSums[k] -= sums[k];
+    }
+  }
+
+  return addedSums[0] > 0.0 || numberOfRemovedPixels > 0.0;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::AccumulatePixel(
+  const InputImagePixelType & pixel,
+  unsigned int                dimension,
+  double *                    sums)
+{
+  double * sum = sums + 1;
+  double * products = sum + dimension;
+
+  for (unsigned int i = 0; i < dimension; ++i)
+  {
+    const auto valueI = static_cast<double>(pixel[i]);
+    products[i * dimension + i] += valueI * valueI;
+    sum[i] += valueI;
+    for (unsigned int j = i + 1; j < dimension; ++j)
+    {
+      const double product = valueI * static_cast<double>(pixel[j]);
+      products[i * dimension + j] += product;
+      products[j * dimension + i] += product;
+    }
+  }
+  sums[0] += 1.0;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::ComputeRegionSums()
+{
+  const InputImagePixelType * input = this->GetInput()->GetBufferPointer();
+  const unsigned int          dimension = this->GetInput()->GetNumberOfComponentsPerPixel();
+  const unsigned int          stride = 1 + dimension + dimension * dimension;
+  const SizeValueType         numberOfPixels = this->GetOutput()->GetBufferedRegion().GetNumberOfPixels();
+  const SizeValueType         numberOfBlocks = (numberOfPixels + PixelsPerBlock - 1) / PixelsPerBlock;
+
+  // Summed block by block in buffer order, so the result does not depend
+  // on the order the region was grown in.
+  std::vector<double> blockSums(numberOfBlocks * stride, 0.0);
+
+  this->ParallelizeBlocks(numberOfPixels, [&](SizeValueType block, SizeValueType begin, SizeValueType end) {
+    double * sums = blockSums.data() + block * stride;
+    for (SizeValueType offset = begin; offset < end; ++offset)
+    {
+      if (m_Status[offset].load(std::memory_order_relaxed) == Accepted)
+      {
+        AccumulatePixel(input[offset], dimension, sums);
+      }
+    }
+  });
+
+  std::fill(m_RegionSums.begin(), m_RegionSums.end(), 0.0);
+  for (SizeValueType block = 0; block < numberOfBlocks; ++block)
+  {
+    for (unsigned int k = 0; k < stride; ++k)
+    {
+      m_RegionSums[k] += blockSums[block * stride + k];
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::ComputeStatisticsFromSums(
+  MeanVectorType &       mean,
+  CovarianceMatrixType & covariance) const
+{
+  const unsigned int dimension = mean.size();
+  const double       numberOfRegionPixels = m_RegionSums[0];
+  const double *     sum = m_RegionSums.data() + 1;
+  const double *     products = sum + dimension;
+
+  for (unsigned int i = 0; i < dimension; ++i)
+  {
+    mean[i] = sum[i] / numberOfRegionPixels;
+    for (unsigned int j = 0; j < dimension; ++j)
+    {
+      covariance[i][j] = products[i * dimension + j] / numberOfRegionPixels;
+    }
+  }
+  for (unsigned int i = 0; i < dimension; ++i)
+  {
+    for (unsigned int j = 0; j < dimension; ++j)
+    {
+      covariance[i][j] -= mean[i] * mean[j];
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParallelVectorConfidenceConnectedImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                                 Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Seeds: " << m_Seeds.size() << std::endl;
+  os << indent << "Multiplier: " << m_Multiplier << std::endl;
+  os << indent << "NumberOfIterations: " << m_NumberOfIterations << std::endl;
+  os << indent << "ReplaceValue: "
+     << static_cast<typename NumericTraits<OutputImagePixelType>::PrintType>(m_ReplaceValue) << std::endl;
+  os << indent << "InitialNeighborhoodRadius: " << m_InitialNeighborhoodRadius << std::endl;
+  os << indent << "UseIncrementalStatistics: " << m_UseIncrementalStatistics << std::endl;
+  os << indent << "ElapsedIterations: " << m_ElapsedIterations << std::endl;
+  os << indent << "ThresholdFunction: " << m_ThresholdFunction.GetPointer() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
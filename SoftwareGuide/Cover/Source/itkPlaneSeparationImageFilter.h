@@ -0,0 +1,104 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkPlaneSeparationImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkPlaneSeparationImageFilter_h
+#define itkPlaneSeparationImageFilter_h
+
+#include "itkInPlaceImageFilter.h"
+#include "itkFixedArray.h"
+
+namespace itk
+{
+
+/** \class PlaneSeparationImageFilter
+ * \brief Replaces the colours lying on the positive side of a plane.
+ *
+ * A pixel with components (r, g, b) is replaced by ReplaceValue when
+ * A * r + B * g + C * b + D > 0, where (A, B, C, D) is the Plane. The
+ * filter runs in place by default and is multithreaded over the output
+ * region.
+ *
+ * When the components are integers of at most 16 bits and the plane
+ * coefficients are integral and small enough for the plane equation to fit
+ * in 32 bits, the test is evaluated in exact integer arithmetic on the raw
+ * component buffer. That loop has no branches and no conversions, so the
+ * compiler vectorizes it. Other planes use double precision, as the
+ * original VWBlueRemoval loop did; both paths give the same decisions.
+ */
+template <typename TImage>
+class ITK_TEMPLATE_EXPORT PlaneSeparationImageFilter : public InPlaceImageFilter<TImage, TImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(PlaneSeparationImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = PlaneSeparationImageFilter;
+  using Superclass = InPlaceImageFilter<TImage, TImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(PlaneSeparationImageFilter);
+
+  using ImageType = TImage;
+  using PixelType = typename ImageType::PixelType;
+  using ComponentType = typename PixelType::ValueType;
+  using OutputImageRegionType = typename ImageType::RegionType;
+
+  /** Plane coefficients (A, B, C, D). */
+  using PlaneType = FixedArray<double, 4>;
+
+  itkSetMacro(Plane, PlaneType);
+  itkGetConstReferenceMacro(Plane, PlaneType);
+
+  /** Value written over the pixels on the positive side of the plane. */
+  itkSetMacro(ReplaceValue, PixelType);
+  itkGetConstReferenceMacro(ReplaceValue, PixelType);
+
+  /** True when the last execution used the exact integer path. */
+  itkGetConstMacro(UsedIntegerPath, bool);
+
+protected:
+  PlaneSeparationImageFilter();
+  ~PlaneSeparationImageFilter() override = default;
+
+  void
+  BeforeThreadedGenerateData() override;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  PlaneType m_Plane{};
+  PixelType m_ReplaceValue{};
+
+  bool m_UsedIntegerPath{ false };
+  int  m_IntegerPlane[4]{};
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkPlaneSeparationImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,161 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkPlaneSeparationImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkPlaneSeparationImageFilter_hxx
+#define itkPlaneSeparationImageFilter_hxx
+
+#include "itkImageScanlineConstIterator.h"
+#include "itkNumericTraits.h"
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace itk
+{
+
+template <typename TImage>
+PlaneSeparationImageFilter<TImage>::PlaneSeparationImageFilter()
+{
+  m_Plane.Fill(0.0);
+  m_ReplaceValue = NumericTraits<PixelType>::ZeroValue();
+
+  this->InPlaceOn();
+  this->DynamicMultiThreadingOn();
+}
+
+
+template <typename TImage>
+void
+PlaneSeparationImageFilter<TImage>::BeforeThreadedGenerateData()
+{
+  m_UsedIntegerPath = false;
+
+  if (!std::is_integral<ComponentType>::value || sizeof(ComponentType) > 2)
+  {
+    return;
+  }
+
+  double bound = std::abs(m_Plane[3]);
+  for (unsigned int k = 0; k < 4; ++k)
+  {
+    if (std::floor(m_Plane[k]) != m_Plane[k])
+    {
+      return;
+    }
+    if (k < 3)
+    {
+      bound += std::abs(m_Plane[k]) * static_cast<double>(NumericTraits<ComponentType>::max());
+    }
+  }
+  if (bound >= static_cast<double>(std::numeric_limits<int>::max()))
+  {
+    return;
+  }
+
+  for (unsigned int k = 0; k < 4; ++k)
+  {
+    m_IntegerPlane[k] = static_cast<int>(m_Plane[k]);
+  }
+  m_UsedIntegerPath = true;
+}
+
+
+template <typename TImage>
+void
+PlaneSeparationImageFilter<TImage>::DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread)
+{
+  constexpr unsigned int numberOfComponents = PixelType::Dimension;
+
+  const ImageType * inputPtr = this->GetInput();
+  ImageType *       outputPtr = this->GetOutput();
+
+  const SizeValueType lineLength = outputRegionForThread.GetSize(0);
+  if (lineLength == 0)
+  {
+    return;
+  }
+
+  ComponentType replace[numberOfComponents];
+  for (unsigned int k = 0; k < numberOfComponents; ++k)
+  {
+    replace[k] = m_ReplaceValue[k];
+  }
+
+  const int    a = m_IntegerPlane[0];
+  const int    b = m_IntegerPlane[1];
+  const int    c = m_IntegerPlane[2];
+  const int    d = m_IntegerPlane[3];
+  const double A = m_Plane[0];
+  const double B = m_Plane[1];
+  const double C = m_Plane[2];
+  const double D = m_Plane[3];
+
+  ImageScanlineConstIterator<ImageType> it(outputPtr, outputRegionForThread);
+
+  while (!it.IsAtEnd())
+  {
+    // Pixels are arrays of components, the scanline is a flat run of them.
+    const auto * in =
+      reinterpret_cast<const ComponentType *>(inputPtr->GetBufferPointer() + inputPtr->ComputeOffset(it.GetIndex()));
+    auto * out =
+      reinterpret_cast<ComponentType *>(outputPtr->GetBufferPointer() + outputPtr->ComputeOffset(it.GetIndex()));
+
+    if (m_UsedIntegerPath)
+    {
+      for (SizeValueType i = 0; i < lineLength; ++i)
+      {
+        const ComponentType * pixel = in + i * numberOfComponents;
+        const bool            onPositiveSide = (a * pixel[0] + b * pixel[1] + c * pixel[2] + d) > 0;
+        for (unsigned int k = 0; k < numberOfComponents; ++k)
+        {
+          out[i * numberOfComponents + k] = onPositiveSide ? replace[k] : pixel[k];
+        }
+      }
+    }
+    else
+    {
+      for (SizeValueType i = 0; i < lineLength; ++i)
+      {
+        const ComponentType * pixel = in + i * numberOfComponents;
+        const bool            onPositiveSide = (A * pixel[0] + B * pixel[1] + C * pixel[2] + D) > 0;
+        for (unsigned int k = 0; k < numberOfComponents; ++k)
+        {
+          out[i * numberOfComponents + k] = onPositiveSide ? replace[k] : pixel[k];
+        }
+      }
+    }
+
+    it.NextLine();
+  }
+}
+
+
+template <typename TImage>
+void
+PlaneSeparationImageFilter<TImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Plane: " << m_Plane << std::endl;
+  os << indent << "ReplaceValue: " << static_cast<typename NumericTraits<PixelType>::PrintType>(m_ReplaceValue)
+     << std::endl;
+  os << indent << "UsedIntegerPath: " << m_UsedIntegerPath << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,184 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRGBHistogramCalculator.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkRGBHistogramCalculator_h
+#define itkRGBHistogramCalculator_h
+
+#include "itkObject.h"
+#include "itkImage.h"
+#include "itkMultiThreaderBase.h"
+#include "itkSparseColorHistogram.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class RGBHistogramCalculator
+ * \brief Computes the full 256x256x256 joint histogram of an 8-bit RGB image.
+ *
+ * Bins are stored in a flat array indexed by the packed colour
+ * red + 256 * green + 65536 * blue, which is also the buffer layout of the
+ * 256^3 histogram image returned by GetHistogramImage().
+ *
+ * With more than one work unit the input region is split into slabs and
+ * each slab is counted into its own private histogram. The private
+ * histograms are then summed bin-block by bin-block in parallel. When the
+ * private copies do not fit in MaximumMemoryInBytes, or when UseAtomicBins
+ * is on, all work units share a single histogram of atomic counters
+ * instead. Integer addition is associative, so every strategy produces
+ * exactly the counts of the serial loop, including the modular wrap-around
+ * of narrow count types.
+ *
+ * With UseSparseBins on, the dense bins are never allocated: every slab is
+ * counted into a hash map keyed by the packed colour and the maps are
+ * merged into a SparseColorHistogram. This is the cheaper choice whenever
+ * the image holds far fewer distinct colours than the 16M bins of the cube.
+ */
+template <typename TInputImage, typename TCount = SizeValueType>
+class ITK_TEMPLATE_EXPORT RGBHistogramCalculator : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(RGBHistogramCalculator);
+
+  /** Standard class type aliases. */
+  using Self = RGBHistogramCalculator;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(RGBHistogramCalculator);
+
+  using ImageType = TInputImage;
+  using ImageConstPointer = typename ImageType::ConstPointer;
+  using RegionType = typename ImageType::RegionType;
+  using PixelType = typename ImageType::PixelType;
+
+  using CountType = TCount;
+  using CountContainerType = std::vector<CountType>;
+  using HistogramImageType = Image<CountType, 3>;
+  using SparseHistogramType = SparseColorHistogram<CountType>;
+
+  static constexpr SizeValueType BinsPerComponent = 256;
+  static constexpr SizeValueType NumberOfBins = BinsPerComponent * BinsPerComponent * BinsPerComponent;
+
+  /** Set the input image. */
+  itkSetConstObjectMacro(Image, ImageType);
+
+  /** Set the region to count. Defaults to the buffered region of the image. */
+  void
+  SetRegion(const RegionType & region)
+  {
+    m_Region = region;
+    m_RegionSetByUser = true;
+    this->Modified();
+  }
+
+  /** Number of slabs counted concurrently. A value of one runs the plain
+   * serial loop. */
+  itkSetClampMacro(NumberOfWorkUnits, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfWorkUnits, ThreadIdType);
+
+  /** Upper bound for the memory used by the private histograms. */
+  itkSetMacro(MaximumMemoryInBytes, SizeValueType);
+  itkGetConstMacro(MaximumMemoryInBytes, SizeValueType);
+
+  /** Share one histogram of atomic counters between the work units. */
+  itkSetMacro(UseAtomicBins, bool);
+  itkGetConstMacro(UseAtomicBins, bool);
+  itkBooleanMacro(UseAtomicBins);
+
+  /** Count into a SparseColorHistogram instead of dense bins. */
+  itkSetMacro(UseSparseBins, bool);
+  itkGetConstMacro(UseSparseBins, bool);
+  itkBooleanMacro(UseSparseBins);
+
+  /** Pack a pixel into its bin index. */
+  static SizeValueType
+  PackColor(const PixelType & pixel)
+  {
+    return static_cast<SizeValueType>(pixel[0]) +
+           BinsPerComponent * (static_cast<SizeValueType>(pixel[1]) +
+                               BinsPerComponent * static_cast<SizeValueType>(pixel[2]));
+  }
+
+  /** Count the pixels of the region. */
+  void
+  Compute();
+
+  /** Counts indexed by PackColor(). Empty when UseSparseBins is on. */
+  const CountContainerType &
+  GetCounts() const
+  {
+    return m_Counts;
+  }
+
+  /** Non-empty bins of the last computation, in either mode. */
+  const SparseHistogramType *
+  GetSparseHistogram() const;
+
+  /** Copy the counts into a 256x256x256 image indexed by (red, green, blue). */
+  typename HistogramImageType::Pointer
+  GetHistogramImage() const;
+
+protected:
+  RGBHistogramCalculator();
+  ~RGBHistogramCalculator() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** Add the pixels of a sub-region to the given bins. */
+  template <typename TBin>
+  void
+  AccumulateRegion(const RegionType & region, TBin * bins) const;
+
+  void
+  ComputeSerial(const RegionType & region);
+
+  void
+  ComputePrivatized(const RegionType & region, unsigned int numberOfPieces);
+
+  void
+  ComputeAtomic(const RegionType & region);
+
+  void
+  ComputeSparse(const RegionType & region);
+
+  ImageConstPointer  m_Image{};
+  RegionType         m_Region{};
+  bool               m_RegionSetByUser{ false };
+  ThreadIdType       m_NumberOfWorkUnits{ 1 };
+  SizeValueType      m_MaximumMemoryInBytes{ 1024 * 1024 * 1024 };
+  bool               m_UseAtomicBins{ false };
+  bool               m_UseSparseBins{ false };
+  CountContainerType m_Counts{};
+
+  typename SparseHistogramType::Pointer m_SparseHistogram{};
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkRGBHistogramCalculator.hxx"
+#endif
+
+#endif
@@ -0,0 +1,316 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRGBHistogramCalculator.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkRGBHistogramCalculator_hxx
+#define itkRGBHistogramCalculator_hxx
+
+#include "itkImageScanlineConstIterator.h"
+#include "itkImageRegionSplitterSlowDimension.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TCount>
+RGBHistogramCalculator<TInputImage, TCount>::RGBHistogramCalculator()
+{
+  m_NumberOfWorkUnits = MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+  m_SparseHistogram = SparseHistogramType::New();
+}
+
+
+template <typename TInputImage, typename TCount>
+template <typename TBin>
+void
+RGBHistogramCalculator<TInputImage, TCount>::AccumulateRegion(const RegionType & region, TBin * bins) const
+{
+  ImageScanlineConstIterator<ImageType> it(m_Image, region);
+
+  while (!it.IsAtEnd())
+  {
+    while (!it.IsAtEndOfLine())
+    {
+      ++bins[PackColor(it.Get())];
+      ++it;
+    }
+    it.NextLine();
+  }
+}
+
+
+template <typename TInputImage, typename TCount>
+void
+RGBHistogramCalculator<TInputImage, TCount>::ComputeSerial(const RegionType & region)
+{
+  this->AccumulateRegion(region, m_Counts.data());
+}
+
+
+template <typename TInputImage, typename TCount>
+void
+RGBHistogramCalculator<TInputImage, TCount>::ComputePrivatized(const RegionType & region,
+                                                               unsigned int       numberOfPieces)
+{
+  auto splitter = ImageRegionSplitterSlowDimension::New();
+  numberOfPieces = splitter->GetNumberOfSplits(region, numberOfPieces);
+
+  // Piece zero counts straight into the result, the others into private
+  // copies that are folded in afterwards.
+  std::vector<CountContainerType> partials(numberOfPieces - 1);
+
+  auto multiThreader = MultiThreaderBase::New();
+  multiThreader->SetNumberOfWorkUnits(m_NumberOfWorkUnits);
+
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfPieces,
+    [&](SizeValueType piece) {
+      RegionType pieceRegion = region;
+      splitter->GetSplit(piece, numberOfPieces, pieceRegion);
+
+      CountType * bins = m_Counts.data();
+      if (piece > 0)
+      {
+        partials[piece - 1].assign(NumberOfBins, CountType{});
+        bins = partials[piece - 1].data();
+      }
+      this->AccumulateRegion(pieceRegion, bins);
+    },
+    nullptr);
+
+  if (partials.empty())
+  {
+    return;
+  }
+
+  constexpr SizeValueType binsPerBlock = BinsPerComponent * BinsPerComponent;
+
+  multiThreader->ParallelizeArray(
+    0,
+    NumberOfBins / binsPerBlock,
+    [&](SizeValueType block) {
+      CountType * const   result = m_Counts.data() + block * binsPerBlock;
+      const SizeValueType offset = block * binsPerBlock;
+      for (const auto & partial : partials)
+      {
+        const CountType * source = partial.data() + offset;
+        for (SizeValueType bin = 0; bin < binsPerBlock; ++bin)
+        {
+          result[bin] += source[bin];
+        }
+      }
+    },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TCount>
+void
+RGBHistogramCalculator<TInputImage, TCount>::ComputeAtomic(const RegionType & region)
+{
+  using AtomicCountType = std::atomic<CountType>;
+
+  // Value-initialization zeroes the counters.
+  std::unique_ptr<AtomicCountType[]> bins(new AtomicCountType[NumberOfBins]());
+
+  auto multiThreader = MultiThreaderBase::New();
+  multiThreader->SetNumberOfWorkUnits(m_NumberOfWorkUnits);
+
+  multiThreader->template ParallelizeImageRegion<ImageType::ImageDimension>(
+    region,
+    [&](const RegionType & pieceRegion) {
+      ImageScanlineConstIterator<ImageType> it(m_Image, pieceRegion);
+      while (!it.IsAtEnd())
+      {
+        while (!it.IsAtEndOfLine())
+        {
+          bins[PackColor(it.Get())].fetch_add(1, std::memory_order_relaxed);
+          ++it;
+        }
+        it.NextLine();
+      }
+    },
+    nullptr);
+
+  for (SizeValueType bin = 0; bin < NumberOfBins; ++bin)
+  {
+    m_Counts[bin] = bins[bin].load(std::memory_order_relaxed);
+  }
+}
+
+
+template <typename TInputImage, typename TCount>
+void
+RGBHistogramCalculator<TInputImage, TCount>::ComputeSparse(const RegionType & region)
+{
+  using MapType = typename SparseHistogramType::MapType;
+  using KeyType = typename SparseHistogramType::KeyType;
+
+  auto               splitter = ImageRegionSplitterSlowDimension::New();
+  const unsigned int numberOfPieces = splitter->GetNumberOfSplits(region, m_NumberOfWorkUnits);
+
+  std::vector<MapType> partials(numberOfPieces);
+
+  auto multiThreader = MultiThreaderBase::New();
+  multiThreader->SetNumberOfWorkUnits(m_NumberOfWorkUnits);
+
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfPieces,
+    [&](SizeValueType piece) {
+      RegionType pieceRegion = region;
+      splitter->GetSplit(piece, numberOfPieces, pieceRegion);
+
+      MapType & counts = partials[piece];
+
+      ImageScanlineConstIterator<ImageType> it(m_Image, pieceRegion);
+      while (!it.IsAtEnd())
+      {
+        while (!it.IsAtEndOfLine())
+        {
+          ++counts[static_cast<KeyType>(PackColor(it.Get()))];
+          ++it;
+        }
+        it.NextLine();
+      }
+    },
+    nullptr);
+
+  for (auto & partial : partials)
+  {
+    m_SparseHistogram->Insert(partial);
+    MapType().swap(partial);
+  }
+}
+
+
+template <typename TInputImage, typename TCount>
+void
+RGBHistogramCalculator<TInputImage, TCount>::Compute()
+{
+  if (!m_Image)
+  {
+    itkExceptionMacro("Input image has not been set");
+  }
+
+  const RegionType region = m_RegionSetByUser ? m_Region : m_Image->GetBufferedRegion();
+
+  m_SparseHistogram->Clear();
+
+  if (m_UseSparseBins)
+  {
+    CountContainerType().swap(m_Counts);
+    this->ComputeSparse(region);
+    return;
+  }
+
+  m_Counts.assign(NumberOfBins, CountType{});
+
+  if (m_NumberOfWorkUnits < 2)
+  {
+    this->ComputeSerial(region);
+    return;
+  }
+
+  // The result buffer is allocated anyway, so one private copy per extra
+  // work unit has to fit in the budget.
+  const SizeValueType histogramBytes = NumberOfBins * sizeof(CountType);
+  const SizeValueType affordableCopies = m_MaximumMemoryInBytes / histogramBytes;
+  const unsigned int  numberOfPieces =
+    static_cast<unsigned int>(std::min<SizeValueType>(m_NumberOfWorkUnits, affordableCopies + 1));
+
+  if (m_UseAtomicBins || numberOfPieces < 2)
+  {
+    itkDebugMacro("Counting with shared atomic bins");
+    this->ComputeAtomic(region);
+  }
+  else
+  {
+    itkDebugMacro("Counting with " << numberOfPieces << " private histograms");
+    this->ComputePrivatized(region, numberOfPieces);
+  }
+}
+
+
+template <typename TInputImage, typename TCount>
+auto
+RGBHistogramCalculator<TInputImage, TCount>::GetSparseHistogram() const -> const SparseHistogramType *
+{
+  if (!m_UseSparseBins && m_SparseHistogram->GetNumberOfEntries() == 0 && m_Counts.size() == NumberOfBins)
+  {
+    m_SparseHistogram->SetDenseCounts(m_Counts.data());
+  }
+  return m_SparseHistogram;
+}
+
+
+template <typename TInputImage, typename TCount>
+auto
+RGBHistogramCalculator<TInputImage, TCount>::GetHistogramImage() const -> typename HistogramImageType::Pointer
+{
+  if (m_UseSparseBins)
+  {
+    return m_SparseHistogram->GetDenseImage();
+  }
+
+  typename HistogramImageType::SizeType size;
+  size.Fill(BinsPerComponent);
+
+  typename HistogramImageType::IndexType start;
+  start.Fill(0);
+
+  typename HistogramImageType::RegionType region;
+  region.SetSize(size);
+  region.SetIndex(start);
+
+  auto histogramImage = HistogramImageType::New();
+  histogramImage->SetRegions(region);
+  histogramImage->Allocate();
+
+  if (m_Counts.size() == NumberOfBins)
+  {
+    std::copy(m_Counts.begin(), m_Counts.end(), histogramImage->GetBufferPointer());
+  }
+  else
+  {
+    histogramImage->FillBuffer(CountType{});
+  }
+
+  return histogramImage;
+}
+
+
+template <typename TInputImage, typename TCount>
+void
+RGBHistogramCalculator<TInputImage, TCount>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Image: " << m_Image.GetPointer() << std::endl;
+  os << indent << "Region: " << m_Region << std::endl;
+  os << indent << "RegionSetByUser: " << m_RegionSetByUser << std::endl;
+  os << indent << "NumberOfWorkUnits: " << m_NumberOfWorkUnits << std::endl;
+  os << indent << "MaximumMemoryInBytes: " << m_MaximumMemoryInBytes << std::endl;
+  os << indent << "UseAtomicBins: " << m_UseAtomicBins << std::endl;
+  os << indent << "UseSparseBins: " << m_UseSparseBins << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,104 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRGBToHSVImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkRGBToHSVImageFilter_h
+#define itkRGBToHSVImageFilter_h
+
+#include "itkUnaryFunctorImageFilter.h"
+#include "itkImageScanlineConstIterator.h"
+#include "itkRGBToHSVFunctor.h"
+
+namespace itk
+{
+
+/** \class RGBToHSVImageFilter
+ * \brief Converts an RGB image into an image holding H, S and V.
+ *
+ * Behaves like a UnaryFunctorImageFilter with the RGBToHSV functor, but
+ * each scanline of the requested region is converted with one call to
+ * Functor::ConvertRGBToHSVBatch, which runs the SSE2 or AVX2 kernel picked
+ * at run time. The input and output pixels must hold three contiguous
+ * components, as RGBPixel, Vector and FixedArray do.
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT RGBToHSVImageFilter
+  : public UnaryFunctorImageFilter<
+      TInputImage,
+      TOutputImage,
+      Functor::RGBToHSV<typename TInputImage::PixelType, typename TOutputImage::PixelType>>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(RGBToHSVImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = RGBToHSVImageFilter;
+  using Superclass = UnaryFunctorImageFilter<
+    TInputImage,
+    TOutputImage,
+    Functor::RGBToHSV<typename TInputImage::PixelType, typename TOutputImage::PixelType>>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using OutputImageRegionType = typename Superclass::OutputImageRegionType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(RGBToHSVImageFilter);
+
+protected:
+  RGBToHSVImageFilter() = default;
+  ~RGBToHSVImageFilter() override = default;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override
+  {
+    const TInputImage * inputPtr = this->GetInput();
+    TOutputImage *      outputPtr = this->GetOutput(0);
+
+    // Define the portion of the input to walk for this thread, using
+    // the CallCopyOutputRegionToInputRegion method allows for the input
+    // and output images to be different dimensions
+    typename TInputImage::RegionType inputRegionForThread;
+
+    this->CallCopyOutputRegionToInputRegion(inputRegionForThread, outputRegionForThread);
+
+    const SizeValueType lineLength = outputRegionForThread.GetSize(0);
+    if (lineLength == 0)
+    {
+      return;
+    }
+
+    ImageScanlineConstIterator<TInputImage> inputIt(inputPtr, inputRegionForThread);
+    ImageScanlineConstIterator<TOutputImage> outputIt(outputPtr, outputRegionForThread);
+
+    while (!inputIt.IsAtEnd())
+    {
+      const auto * input = inputPtr->GetBufferPointer() + inputPtr->ComputeOffset(inputIt.GetIndex());
+      auto *       output = outputPtr->GetBufferPointer() + outputPtr->ComputeOffset(outputIt.GetIndex());
+
+      Functor::ConvertRGBToHSVBatch(input, output, lineLength);
+
+      inputIt.NextLine();
+      outputIt.NextLine();
+    }
+  }
+};
+
+} // end namespace itk
+
+#endif
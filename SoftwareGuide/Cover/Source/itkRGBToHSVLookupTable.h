@@ -0,0 +1,121 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRGBToHSVLookupTable.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkRGBToHSVLookupTable_h
+#define itkRGBToHSVLookupTable_h
+
+#include "itkRGBToHSVFunctor.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+namespace Functor
+{
+
+/** \class RGBToHSVLookupTable
+ * \brief Table driven ConvertRGBToHSV for 8-bit colour components.
+ *
+ * A direct table over the 2^24 colours would take 192 MB. Instead the
+ * conversion is factored along the quantities each channel actually
+ * depends on:
+ *
+ *   V depends on R + G + B only            (766 entries),
+ *   S depends on min(R, G, B) and R + G + B (256 x 766 entries),
+ *   H depends on R - G and R - B           (511 x 511 entries).
+ *
+ * Every entry is produced by calling ConvertRGBToHSV on a colour with the
+ * corresponding key, and the arithmetic of ConvertRGBToHSV is exact on
+ * those keys, so the lookups are bit-identical to the direct conversion.
+ * The three tables take about 1.8 MB and are built once per process.
+ */
+class RGBToHSVLookupTable
+{
+public:
+  static constexpr int ComponentMaximum = 255;
+  static constexpr int NumberOfSums = 3 * ComponentMaximum + 1;
+  static constexpr int NumberOfDifferences = 2 * ComponentMaximum + 1;
+
+  /** Shared instance, built on first use. */
+  static const RGBToHSVLookupTable &
+  GetInstance()
+  {
+    static const RGBToHSVLookupTable table;
+    return table;
+  }
+
+  void
+  Evaluate(unsigned char R, unsigned char G, unsigned char B, float & H, float & S, float & V) const
+  {
+    const int sum = R + G + B;
+    const int minimum = std::min(R, std::min(G, B));
+
+    H = m_Hue[(R - G + ComponentMaximum) * NumberOfDifferences + (R - B + ComponentMaximum)];
+    S = m_Saturation[minimum * NumberOfSums + sum];
+    V = m_Value[sum];
+  }
+
+private:
+  RGBToHSVLookupTable()
+    : m_Hue(NumberOfDifferences * NumberOfDifferences)
+    , m_Saturation((ComponentMaximum + 1) * NumberOfSums)
+    , m_Value(NumberOfSums)
+  {
+    float H;
+    float S;
+    float V;
+
+    for (int sum = 0; sum < NumberOfSums; ++sum)
+    {
+      const int R = std::min(sum, ComponentMaximum);
+      const int G = std::min(sum - R, ComponentMaximum);
+      ConvertRGBToHSV(R, G, sum - R - G, H, S, V);
+      m_Value[sum] = V;
+    }
+
+    // Only pairs with 3 * minimum <= sum <= minimum + 2 * 255 are reachable.
+    for (int minimum = 0; minimum <= ComponentMaximum; ++minimum)
+    {
+      for (int sum = 3 * minimum; sum <= std::min(minimum + 2 * ComponentMaximum, NumberOfSums - 1); ++sum)
+      {
+        const int rest = sum - minimum;
+        const int R = std::min(ComponentMaximum, rest - minimum);
+        ConvertRGBToHSV(R, rest - R, minimum, H, S, V);
+        m_Saturation[minimum * NumberOfSums + sum] = S;
+      }
+    }
+
+    for (int redMinusGreen = -ComponentMaximum; redMinusGreen <= ComponentMaximum; ++redMinusGreen)
+    {
+      for (int redMinusBlue = -ComponentMaximum; redMinusBlue <= ComponentMaximum; ++redMinusBlue)
+      {
+        const int R = std::max(0, std::max(redMinusGreen, redMinusBlue));
+        ConvertRGBToHSV(R, R - redMinusGreen, R - redMinusBlue, H, S, V);
+        m_Hue[(redMinusGreen + ComponentMaximum) * NumberOfDifferences + (redMinusBlue + ComponentMaximum)] = H;
+      }
+    }
+  }
+
+  std::vector<float> m_Hue;
+  std::vector<float> m_Saturation;
+  std::vector<float> m_Value;
+};
+
+} // end namespace Functor
+} // end namespace itk
+
+#endif
@@ -0,0 +1,131 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRunningSumBinaryMedianImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkRunningSumBinaryMedianImageFilter_h
+#define itkRunningSumBinaryMedianImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace itk
+{
+
+/** \class RunningSumBinaryMedianImageFilter
+ * \brief BinaryMedianImageFilter whose cost does not grow with the radius.
+ *
+ * On a binary image the median of a window is the foreground value when
+ * more than half of the window holds it, so only the number of foreground
+ * pixels in the box around every pixel is needed. That count is separable:
+ * it is computed with one running sum per dimension, each costing two
+ * additions per pixel whatever the radius.
+ *
+ * The box sums of the slices across the slowest dimension are added to an
+ * accumulator as they enter the window and subtracted as they leave it.
+ * The output region is cut into slabs along that dimension, at least one
+ * window deep, that are processed in parallel; each slab holds only two
+ * slices of counts.
+ *
+ * Pixels outside the input buffer take the value of the nearest pixel
+ * inside, as with the zero-flux Neumann boundary condition of
+ * BinaryMedianImageFilter, and pixels that are neither foreground nor
+ * background count as background. The output is therefore identical to
+ * BinaryMedianImageFilter with the same radius and values.
+ */
+template <typename TInputImage, typename TOutputImage = TInputImage>
+class ITK_TEMPLATE_EXPORT RunningSumBinaryMedianImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(RunningSumBinaryMedianImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = RunningSumBinaryMedianImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(RunningSumBinaryMedianImageFilter);
+
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  using InputImageType = TInputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+  using InputImageRegionType = typename InputImageType::RegionType;
+  using InputSizeType = typename InputImageType::SizeType;
+
+  using OutputImageType = TOutputImage;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  /** Foreground counts, wide enough for windows of 2^32 - 1 pixels. */
+  using CountType = std::uint32_t;
+
+  /** Radius of the window along every dimension. */
+  itkSetMacro(Radius, InputSizeType);
+  itkGetConstReferenceMacro(Radius, InputSizeType);
+
+  itkSetMacro(ForegroundValue, InputPixelType);
+  itkGetConstMacro(ForegroundValue, InputPixelType);
+
+  itkSetMacro(BackgroundValue, InputPixelType);
+  itkGetConstMacro(BackgroundValue, InputPixelType);
+
+protected:
+  RunningSumBinaryMedianImageFilter();
+  ~RunningSumBinaryMedianImageFilter() override = default;
+
+  /** The input is padded by the radius, as for BinaryMedianImageFilter. */
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** Running sum over a line of n values, each output the sum of the
+   * 2 * radius + 1 values around it with the ends repeated. */
+  static void
+  BoxSumLine(const CountType * in, CountType * out, SizeValueType outStride, SizeValueType n, SizeValueType radius);
+
+  /** Foreground count of the box around every pixel of input slice k
+   * across the slowest dimension, excluding that dimension. */
+  void
+  ComputeSliceCounts(IndexValueType k, CountType * slice, CountType * line) const;
+
+  /** Process the output slices [first, end) along the slowest dimension. */
+  void
+  ProcessSlab(IndexValueType first, IndexValueType end);
+
+  InputSizeType  m_Radius{};
+  InputPixelType m_ForegroundValue{};
+  InputPixelType m_BackgroundValue{};
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkRunningSumBinaryMedianImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,313 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkRunningSumBinaryMedianImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkRunningSumBinaryMedianImageFilter_hxx
+#define itkRunningSumBinaryMedianImageFilter_hxx
+
+#include "itkImageScanlineIterator.h"
+#include "itkMultiThreaderBase.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+RunningSumBinaryMedianImageFilter<TInputImage, TOutputImage>::RunningSumBinaryMedianImageFilter()
+{
+  m_Radius.Fill(1);
+  m_ForegroundValue = NumericTraits<InputPixelType>::max();
+  m_BackgroundValue = NumericTraits<InputPixelType>::NonpositiveMin();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+RunningSumBinaryMedianImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  auto * inputPtr = const_cast<InputImageType *>(this->GetInput());
+  if (!inputPtr || !this->GetOutput())
+  {
+    return;
+  }
+
+  InputImageRegionType inputRequestedRegion = inputPtr->GetRequestedRegion();
+  inputRequestedRegion.PadByRadius(m_Radius);
+
+  if (!inputRequestedRegion.Crop(inputPtr->GetLargestPossibleRegion()))
+  {
+    inputPtr->SetRequestedRegion(inputRequestedRegion);
+    InvalidRequestedRegionError e(__FILE__, __LINE__);
+    e.SetLocation(ITK_LOCATION);
+    e.SetDescription("Requested region is (at least partially) outside the largest possible region.");
+    e.SetDataObject(inputPtr);
+    throw e;
+  }
+  inputPtr->SetRequestedRegion(inputRequestedRegion);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+RunningSumBinaryMedianImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  SizeValueType windowSize = 1;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    windowSize *= 2 * m_Radius[d] + 1;
+  }
+  // Leave room for the value entering a running sum before the one leaving it.
+  if (windowSize > std::numeric_limits<CountType>::max() / 2)
+  {
+    itkExceptionMacro(<< "Radius " << m_Radius << " gives a window too large to count");
+  }
+
+  constexpr unsigned int      SlowDimension = ImageDimension - 1;
+  const OutputImageRegionType outputRegion = this->GetOutput()->GetRequestedRegion();
+  const SizeValueType         numberOfSlices = outputRegion.GetSize(SlowDimension);
+  if (numberOfSlices == 0)
+  {
+    return;
+  }
+
+  // Every slab starts by summing a full window of slices, so slabs are at
+  // least one window deep to keep that cost below the sliding itself.
+  const SizeValueType window = 2 * m_Radius[SlowDimension] + 1;
+  const SizeValueType numberOfSlabs =
+    std::max<SizeValueType>(1, std::min<SizeValueType>(this->GetNumberOfWorkUnits(), numberOfSlices / window));
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfSlabs,
+    [&](SizeValueType slab) {
+      const IndexValueType start = outputRegion.GetIndex(SlowDimension);
+      this->ProcessSlab(start + static_cast<IndexValueType>(slab * numberOfSlices / numberOfSlabs),
+                        start + static_cast<IndexValueType>((slab + 1) * numberOfSlices / numberOfSlabs));
+    },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+RunningSumBinaryMedianImageFilter<TInputImage, TOutputImage>::BoxSumLine(const CountType * in,
+                                                                         CountType *       out,
+                                                                         SizeValueType     outStride,
+                                                                         SizeValueType     n,
+                                                                         SizeValueType     radius)
+{
+  // Window of the first value: radius + 1 copies of in[0], then in[1] up
+  // to in[radius], the last value repeated past the end.
+  const SizeValueType inner = std::min(radius, n - 1);
+
+  CountType sum = static_cast<CountType>(radius + 1) * in[0];
+  for (SizeValueType j = 1; j <= inner; ++j)
+  {
+    sum += in[j];
+  }
+  sum += static_cast<CountType>(radius - inner) * in[n - 1];
+
+  for (SizeValueType i = 0; i < n; ++i)
+  {
+    out[i * outStride] = sum;
+    sum += i + radius + 1 < n ? in[i + radius + 1] : in[n - 1];
+    sum -= i >= radius ? in[i - radius] : in[0];
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+RunningSumBinaryMedianImageFilter<TInputImage, TOutputImage>::ComputeSliceCounts(IndexValueType k,
+                                                                                 CountType *    slice,
+                                                                                 CountType *    line) const
+{
+  constexpr unsigned int SlowDimension = ImageDimension - 1;
+
+  const InputImageType *     input = this->GetInput();
+  const InputImageRegionType bufferedRegion = input->GetBufferedRegion();
+  const InputPixelType *     inputSlice =
+    input->GetBufferPointer() + static_cast<SizeValueType>(k - bufferedRegion.GetIndex(SlowDimension)) *
+                                  input->GetOffsetTable()[SlowDimension];
+
+  SizeValueType sliceSize = 1;
+  for (unsigned int d = 0; d < SlowDimension; ++d)
+  {
+    sliceSize *= bufferedRegion.GetSize(d);
+  }
+
+  if (SlowDimension == 0)
+  {
+    slice[0] = inputSlice[0] == m_ForegroundValue;
+    return;
+  }
+
+  // Along the fastest dimension, from the foreground indicator.
+  const SizeValueType lineLength = bufferedRegion.GetSize(0);
+  for (SizeValueType lineStart = 0; lineStart < sliceSize; lineStart += lineLength)
+  {
+    for (SizeValueType i = 0; i < lineLength; ++i)
+    {
+      line[i] = inputSlice[lineStart + i] == m_ForegroundValue;
+    }
+    BoxSumLine(line, slice + lineStart, 1, lineLength, m_Radius[0]);
+  }
+
+  // Along the other dimensions of the slice, in place through the line.
+  SizeValueType stride = lineLength;
+  for (unsigned int d = 1; d < SlowDimension; ++d)
+  {
+    const SizeValueType n = bufferedRegion.GetSize(d);
+    const SizeValueType block = stride * n;
+    for (SizeValueType blockStart = 0; blockStart < sliceSize; blockStart += block)
+    {
+      for (SizeValueType inner = 0; inner < stride; ++inner)
+      {
+        CountType * values = slice + blockStart + inner;
+        for (SizeValueType i = 0; i < n; ++i)
+        {
+          line[i] = values[i * stride];
+        }
+        BoxSumLine(line, values, stride, n, m_Radius[d]);
+      }
+    }
+    stride = block;
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+RunningSumBinaryMedianImageFilter<TInputImage, TOutputImage>::ProcessSlab(IndexValueType first, IndexValueType end)
+{
+  constexpr unsigned int SlowDimension = ImageDimension - 1;
+
+  const InputImageType *     input = this->GetInput();
+  OutputImageType *          output = this->GetOutput();
+  const InputImageRegionType bufferedRegion = input->GetBufferedRegion();
+
+  SizeValueType sliceSize = 1;
+  SizeValueType longestLine = 1;
+  for (unsigned int d = 0; d < SlowDimension; ++d)
+  {
+    sliceSize *= bufferedRegion.GetSize(d);
+    longestLine = std::max(longestLine, bufferedRegion.GetSize(d));
+  }
+
+  std::vector<CountType> counts(sliceSize, 0);
+  std::vector<CountType> slice(sliceSize);
+  std::vector<CountType> line(longestLine);
+
+  const IndexValueType lowest = bufferedRegion.GetIndex(SlowDimension);
+  const IndexValueType highest = lowest + static_cast<IndexValueType>(bufferedRegion.GetSize(SlowDimension)) - 1;
+  const auto           radius = static_cast<IndexValueType>(m_Radius[SlowDimension]);
+  const auto clampSlice = [&](IndexValueType k) { return std::min(std::max(k, lowest), highest); };
+
+  const auto addSlice = [&](IndexValueType k, CountType multiplicity) {
+    this->ComputeSliceCounts(k, slice.data(), line.data());
+    for (SizeValueType i = 0; i < sliceSize; ++i)
+    {
+      counts[i] += multiplicity * slice[i];
+    }
+  };
+
+  // Window of the first slice, each buffered slice counted as many times
+  // as the clamped window repeats it.
+  const IndexValueType windowFirst = first - radius;
+  const IndexValueType windowLast = first + radius;
+  for (IndexValueType k = std::max(windowFirst, lowest); k <= std::min(windowLast, highest); ++k)
+  {
+    IndexValueType repeatFirst = k == lowest ? windowFirst : k;
+    IndexValueType repeatLast = k == highest ? windowLast : k;
+    addSlice(k, static_cast<CountType>(repeatLast - repeatFirst + 1));
+  }
+
+  SizeValueType windowSize = 1;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    windowSize *= 2 * m_Radius[d] + 1;
+  }
+  const SizeValueType medianPosition = windowSize / 2;
+
+  const OutputImageRegionType outputRegion = output->GetRequestedRegion();
+  const auto                  foreground = static_cast<OutputPixelType>(m_ForegroundValue);
+  const auto background = static_cast<OutputPixelType>(m_BackgroundValue);
+
+  for (IndexValueType k = first; k < end; ++k)
+  {
+    if (k > first)
+    {
+      const IndexValueType entering = clampSlice(k + radius);
+      const IndexValueType leaving = clampSlice(k - radius - 1);
+      if (entering != leaving)
+      {
+        addSlice(entering, 1);
+        this->ComputeSliceCounts(leaving, slice.data(), line.data());
+        for (SizeValueType i = 0; i < sliceSize; ++i)
+        {
+          counts[i] -= slice[i];
+        }
+      }
+    }
+
+    OutputImageRegionType sliceRegion = outputRegion;
+    sliceRegion.SetIndex(SlowDimension, k);
+    sliceRegion.SetSize(SlowDimension, 1);
+
+    typename InputImageType::IndexType sliceOrigin = bufferedRegion.GetIndex();
+    sliceOrigin[SlowDimension] = k;
+    const OffsetValueType sliceOffset = input->ComputeOffset(sliceOrigin);
+
+    ImageScanlineIterator<OutputImageType> it(output, sliceRegion);
+    while (!it.IsAtEnd())
+    {
+      const CountType * lineCounts = counts.data() + (input->ComputeOffset(it.GetIndex()) - sliceOffset);
+      SizeValueType     i = 0;
+      while (!it.IsAtEndOfLine())
+      {
+        it.Set(lineCounts[i++] > medianPosition ? foreground : background);
+        ++it;
+      }
+      it.NextLine();
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+RunningSumBinaryMedianImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Radius: " << m_Radius << std::endl;
+  os << indent << "ForegroundValue: " << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_ForegroundValue)
+     << std::endl;
+  os << indent << "BackgroundValue: " << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_BackgroundValue)
+     << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,123 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkSmoothedSignedDistanceImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkSmoothedSignedDistanceImageFilter_hxx
+#define itkSmoothedSignedDistanceImageFilter_hxx
+
+#include "itkNumericTraits.h"
+
+#include <cmath>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+SmoothedSignedDistanceImageFilter<TInputImage, TOutputImage>::SmoothedSignedDistanceImageFilter()
+{
+  m_DistanceFilter = DistanceFilterType::New();
+  m_DistanceFilter->SetInsideIsPositive(true);
+  m_DistanceFilter->SetSquaredDistance(false);
+  m_DistanceFilter->SetUseImageSpacing(true);
+
+  m_ClampFilter = ClampFilterType::New();
+  m_ClampFilter->SetInput(m_DistanceFilter->GetOutput());
+  m_ClampFilter->InPlaceOn();
+
+  m_SmoothingFilter = SmoothingFilterType::New();
+  m_SmoothingFilter->SetInput(m_ClampFilter->GetOutput());
+  m_SmoothingFilter->InPlaceOn();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+SmoothedSignedDistanceImageFilter<TInputImage, TOutputImage>::GetReach(const SpacingType & spacing) const
+  -> InputSizeType
+{
+  InputSizeType reach;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    reach[d] = static_cast<SizeValueType>(std::ceil((m_MaximumDistance + 4.0 * m_Sigma) / spacing[d]));
+  }
+  return reach;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+SmoothedSignedDistanceImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  if (this->GetInput())
+  {
+    auto * input = const_cast<InputImageType *>(this->GetInput());
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+SmoothedSignedDistanceImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+SmoothedSignedDistanceImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  // A graft, so that the mini-pipeline does not update the pipeline
+  // upstream.
+  auto input = InputImageType::New();
+  input->Graft(this->GetInput());
+
+  const auto bound = static_cast<OutputPixelType>(m_MaximumDistance);
+
+  m_DistanceFilter->SetInput(input);
+  m_DistanceFilter->SetBackgroundValue(m_BackgroundValue);
+  m_DistanceFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  m_ClampFilter->SetBounds(-bound, bound);
+  m_ClampFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  m_SmoothingFilter->SetSigma(m_Sigma);
+  m_SmoothingFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  m_SmoothingFilter->GraftOutput(this->GetOutput());
+  m_SmoothingFilter->Update();
+  this->GraftOutput(m_SmoothingFilter->GetOutput());
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+SmoothedSignedDistanceImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "BackgroundValue: " << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_BackgroundValue)
+     << std::endl;
+  os << indent << "Sigma: " << m_Sigma << std::endl;
+  os << indent << "MaximumDistance: " << m_MaximumDistance << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,152 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkSparseBandLevelSet.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkSparseBandLevelSet_h
+#define itkSparseBandLevelSet_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkImage.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+
+/** \class SparseBandLevelSet
+ * \brief Level set of a binary mask stored on a narrow band only.
+ *
+ * The band values are kept as (offset, value) entries sorted by their
+ * offset in the buffer of the image. Every pixel off the band holds
+ * OutsideValue, positive on the foreground of the mask it was computed
+ * from and negative elsewhere, so the sign is implicit and GetDenseImage()
+ * needs that mask to rebuild the full level set.
+ *
+ * Write() and Read() use a compact binary format: the magic "SBL1", the
+ * dimension, the index and size of the region as LEB128 varints, the
+ * spacing, origin and direction as doubles, OutsideValue and the number of
+ * entries, and then for every entry the offset delta to the previous entry
+ * as a varint followed by the value as a float. Floating point values are
+ * stored in the byte order of the machine.
+ */
+template <unsigned int VDimension>
+class ITK_TEMPLATE_EXPORT SparseBandLevelSet : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(SparseBandLevelSet);
+
+  /** Standard class type aliases. */
+  using Self = SparseBandLevelSet;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(SparseBandLevelSet);
+
+  static constexpr unsigned int ImageDimension = VDimension;
+
+  using ValueType = float;
+  using EntryType = std::pair<SizeValueType, ValueType>;
+  using EntryContainerType = std::vector<EntryType>;
+  using DenseImageType = Image<ValueType, VDimension>;
+  using RegionType = typename DenseImageType::RegionType;
+  using SpacingType = typename DenseImageType::SpacingType;
+  using PointType = typename DenseImageType::PointType;
+  using DirectionType = typename DenseImageType::DirectionType;
+
+  /** Take the largest possible region, spacing, origin and direction of
+   * an image. */
+  void
+  CopyInformation(const ImageBase<VDimension> * image);
+
+  itkGetConstReferenceMacro(Region, RegionType);
+  itkGetConstReferenceMacro(Spacing, SpacingType);
+  itkGetConstReferenceMacro(Origin, PointType);
+  itkGetConstReferenceMacro(Direction, DirectionType);
+
+  /** Magnitude of the level set off the band. */
+  itkSetMacro(OutsideValue, ValueType);
+  itkGetConstMacro(OutsideValue, ValueType);
+
+  /** Replace the entries, which must be sorted by offset. */
+  void
+  SetEntries(EntryContainerType entries);
+
+  /** Entries sorted by offset. */
+  const EntryContainerType &
+  GetEntries() const
+  {
+    return m_Entries;
+  }
+
+  SizeValueType
+  GetNumberOfEntries() const
+  {
+    return m_Entries.size();
+  }
+
+  /** Build the full level set, taking the sign off the band from \a mask,
+   * which must cover the region of the band. */
+  template <typename TMaskImage>
+  typename DenseImageType::Pointer
+  GetDenseImage(const TMaskImage * mask, const typename TMaskImage::PixelType & foreground) const;
+
+  /** Stream the band to disk in the compact format. */
+  void
+  Write(const std::string & fileName) const;
+
+  /** Load a band written by Write(). */
+  void
+  Read(const std::string & fileName);
+
+  /** True when the file name carries the sparse band extension. */
+  static bool
+  IsSparseFileName(const std::string & fileName)
+  {
+    const std::string extension = ".sbl";
+    return fileName.size() >= extension.size() &&
+           fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+  }
+
+protected:
+  SparseBandLevelSet();
+  ~SparseBandLevelSet() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  RegionType         m_Region{};
+  SpacingType        m_Spacing{};
+  PointType          m_Origin{};
+  DirectionType      m_Direction{};
+  ValueType          m_OutsideValue{ 1 };
+  EntryContainerType m_Entries{};
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkSparseBandLevelSet.hxx"
+#endif
+
+#endif
@@ -0,0 +1,280 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkSparseBandLevelSet.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkSparseBandLevelSet_hxx
+#define itkSparseBandLevelSet_hxx
+
+#include "itkSparseColorHistogram.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace itk
+{
+
+namespace SparseBandLevelSetDetail
+{
+constexpr char Magic[4] = { 'S', 'B', 'L', '1' };
+
+template <typename T>
+inline void
+WriteRaw(std::ostream & os, const T & value)
+{
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+inline bool
+ReadRaw(std::istream & is, T & value)
+{
+  return static_cast<bool>(is.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+/** Signed indices are zigzag encoded before going through a varint. */
+inline std::uint64_t
+ZigZag(IndexValueType value)
+{
+  return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value < 0 ? -1 : 0);
+}
+
+inline IndexValueType
+UnZigZag(std::uint64_t value)
+{
+  return static_cast<IndexValueType>((value >> 1) ^ (~(value & 1) + 1));
+}
+} // end namespace SparseBandLevelSetDetail
+
+
+template <unsigned int VDimension>
+SparseBandLevelSet<VDimension>::SparseBandLevelSet()
+{
+  m_Spacing.Fill(1.0);
+  m_Origin.Fill(0.0);
+  m_Direction.SetIdentity();
+}
+
+
+template <unsigned int VDimension>
+void
+SparseBandLevelSet<VDimension>::CopyInformation(const ImageBase<VDimension> * image)
+{
+  m_Region = image->GetLargestPossibleRegion();
+  m_Spacing = image->GetSpacing();
+  m_Origin = image->GetOrigin();
+  m_Direction = image->GetDirection();
+  this->Modified();
+}
+
+
+template <unsigned int VDimension>
+void
+SparseBandLevelSet<VDimension>::SetEntries(EntryContainerType entries)
+{
+  m_Entries = std::move(entries);
+  this->Modified();
+}
+
+
+template <unsigned int VDimension>
+template <typename TMaskImage>
+auto
+SparseBandLevelSet<VDimension>::GetDenseImage(const TMaskImage *                      mask,
+                                              const typename TMaskImage::PixelType & foreground) const ->
+  typename DenseImageType::Pointer
+{
+  if (mask->GetBufferedRegion() != m_Region)
+  {
+    itkExceptionMacro(<< "The mask buffers " << mask->GetBufferedRegion() << " but the band covers " << m_Region);
+  }
+
+  auto image = DenseImageType::New();
+  image->SetRegions(m_Region);
+  image->SetSpacing(m_Spacing);
+  image->SetOrigin(m_Origin);
+  image->SetDirection(m_Direction);
+  image->Allocate();
+
+  const typename TMaskImage::PixelType * maskBuffer = mask->GetBufferPointer();
+  ValueType *                            buffer = image->GetBufferPointer();
+  const SizeValueType                    numberOfPixels = m_Region.GetNumberOfPixels();
+  for (SizeValueType offset = 0; offset < numberOfPixels; ++offset)
+  {
+    buffer[offset] = maskBuffer[offset] == foreground ? m_OutsideValue : -m_OutsideValue;
+  }
+  for (const auto & entry : m_Entries)
+  {
+    buffer[entry.first] = entry.second;
+  }
+
+  return image;
+}
+
+
+template <unsigned int VDimension>
+void
+SparseBandLevelSet<VDimension>::Write(const std::string & fileName) const
+{
+  std::ofstream os(fileName, std::ios::binary);
+  if (!os)
+  {
+    itkExceptionMacro("Cannot open " << fileName << " for writing");
+  }
+
+  os.write(SparseBandLevelSetDetail::Magic, sizeof(SparseBandLevelSetDetail::Magic));
+  os.put(static_cast<char>(VDimension));
+  for (unsigned int d = 0; d < VDimension; ++d)
+  {
+    SparseColorHistogramDetail::WriteVarint(os, SparseBandLevelSetDetail::ZigZag(m_Region.GetIndex(d)));
+    SparseColorHistogramDetail::WriteVarint(os, m_Region.GetSize(d));
+  }
+  for (unsigned int d = 0; d < VDimension; ++d)
+  {
+    SparseBandLevelSetDetail::WriteRaw(os, static_cast<double>(m_Spacing[d]));
+    SparseBandLevelSetDetail::WriteRaw(os, static_cast<double>(m_Origin[d]));
+    for (unsigned int e = 0; e < VDimension; ++e)
+    {
+      SparseBandLevelSetDetail::WriteRaw(os, static_cast<double>(m_Direction[d][e]));
+    }
+  }
+  SparseBandLevelSetDetail::WriteRaw(os, m_OutsideValue);
+  SparseColorHistogramDetail::WriteVarint(os, m_Entries.size());
+
+  SizeValueType previousOffset = 0;
+  for (const auto & entry : m_Entries)
+  {
+    SparseColorHistogramDetail::WriteVarint(os, entry.first - previousOffset);
+    SparseBandLevelSetDetail::WriteRaw(os, entry.second);
+    previousOffset = entry.first;
+  }
+
+  if (!os)
+  {
+    itkExceptionMacro("Error while writing " << fileName);
+  }
+}
+
+
+template <unsigned int VDimension>
+void
+SparseBandLevelSet<VDimension>::Read(const std::string & fileName)
+{
+  std::ifstream is(fileName, std::ios::binary);
+  if (!is)
+  {
+    itkExceptionMacro("Cannot open " << fileName << " for reading");
+  }
+
+  char magic[sizeof(SparseBandLevelSetDetail::Magic)];
+  is.read(magic, sizeof(magic));
+  if (!is || !std::equal(magic, magic + sizeof(magic), SparseBandLevelSetDetail::Magic))
+  {
+    itkExceptionMacro(<< fileName << " is not a sparse band level set");
+  }
+
+  const int dimension = is.get();
+  if (dimension != static_cast<int>(VDimension))
+  {
+    itkExceptionMacro(<< fileName << " holds a level set of dimension " << dimension << ", not " << VDimension);
+  }
+
+  RegionType region;
+  for (unsigned int d = 0; d < VDimension; ++d)
+  {
+    std::uint64_t index;
+    std::uint64_t size;
+    if (!SparseColorHistogramDetail::ReadVarint(is, index) || !SparseColorHistogramDetail::ReadVarint(is, size))
+    {
+      itkExceptionMacro(<< fileName << " is truncated");
+    }
+    region.SetIndex(d, SparseBandLevelSetDetail::UnZigZag(index));
+    region.SetSize(d, static_cast<SizeValueType>(size));
+  }
+
+  SpacingType   spacing;
+  PointType     origin;
+  DirectionType direction;
+  bool          complete = true;
+  for (unsigned int d = 0; d < VDimension; ++d)
+  {
+    double value = 0.0;
+    complete = complete && SparseBandLevelSetDetail::ReadRaw(is, value);
+    spacing[d] = value;
+    complete = complete && SparseBandLevelSetDetail::ReadRaw(is, value);
+    origin[d] = value;
+    for (unsigned int e = 0; e < VDimension; ++e)
+    {
+      complete = complete && SparseBandLevelSetDetail::ReadRaw(is, value);
+      direction[d][e] = value;
+    }
+  }
+
+  ValueType     outsideValue{};
+  std::uint64_t numberOfEntries = 0;
+  if (!complete || !SparseBandLevelSetDetail::ReadRaw(is, outsideValue) ||
+      !SparseColorHistogramDetail::ReadVarint(is, numberOfEntries))
+  {
+    itkExceptionMacro(<< fileName << " is truncated");
+  }
+
+  const std::uint64_t numberOfPixels = region.GetNumberOfPixels();
+
+  EntryContainerType entries;
+  entries.reserve(std::min(numberOfEntries, numberOfPixels));
+
+  std::uint64_t offset = 0;
+  for (std::uint64_t n = 0; n < numberOfEntries; ++n)
+  {
+    std::uint64_t delta;
+    ValueType     value;
+    if (!SparseColorHistogramDetail::ReadVarint(is, delta) || !SparseBandLevelSetDetail::ReadRaw(is, value))
+    {
+      itkExceptionMacro(<< fileName << " is truncated");
+    }
+    offset += delta;
+    if (offset >= numberOfPixels)
+    {
+      itkExceptionMacro(<< fileName << " contains an offset outside of its region");
+    }
+    entries.emplace_back(static_cast<SizeValueType>(offset), value);
+  }
+
+  m_Region = region;
+  m_Spacing = spacing;
+  m_Origin = origin;
+  m_Direction = direction;
+  m_OutsideValue = outsideValue;
+  m_Entries.swap(entries);
+  this->Modified();
+}
+
+
+template <unsigned int VDimension>
+void
+SparseBandLevelSet<VDimension>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Region: " << m_Region << std::endl;
+  os << indent << "Spacing: " << m_Spacing << std::endl;
+  os << indent << "Origin: " << m_Origin << std::endl;
+  os << indent << "Direction: " << m_Direction << std::endl;
+  os << indent << "OutsideValue: " << m_OutsideValue << std::endl;
+  os << indent << "NumberOfEntries: " << m_Entries.size() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkSparseColorHistogram.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkSparseColorHistogram_h
+#define itkSparseColorHistogram_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkImage.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+
+/** \class SparseColorHistogram
+ * \brief Sparse 256x256x256 histogram keyed by packed 24-bit bin indices.
+ *
+ * Only the non-empty bins are kept, as a run list of (key, count) entries
+ * sorted by key. The key of bin (i, j, k) is i + 256 * j + 65536 * k, so the
+ * entries appear in the buffer order of the equivalent dense histogram
+ * image, which GetDenseImage() rebuilds on demand.
+ *
+ * Write() and Read() use a compact binary format: the magic "SCH1", the
+ * byte width of the counts, the number of entries, and then for every
+ * entry the key delta to the previous entry followed by the count, both as
+ * unsigned LEB128 varints. Tissue colours occupy a small fraction of the
+ * colour cube, so files are typically a few hundred kilobytes instead of
+ * the 32 MB of the dense image.
+ */
+template <typename TCount = SizeValueType>
+class ITK_TEMPLATE_EXPORT SparseColorHistogram : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(SparseColorHistogram);
+
+  /** Standard class type aliases. */
+  using Self = SparseColorHistogram;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(SparseColorHistogram);
+
+  using KeyType = std::uint32_t;
+  using CountType = TCount;
+  using EntryType = std::pair<KeyType, CountType>;
+  using EntryContainerType = std::vector<EntryType>;
+  using MapType = std::unordered_map<KeyType, CountType>;
+  using DenseImageType = Image<CountType, 3>;
+  using IndexType = typename DenseImageType::IndexType;
+
+  static constexpr KeyType BinsPerComponent = 256;
+
+  /** Pack the three 8-bit bin indices into a key. */
+  static KeyType
+  PackIndex(unsigned int i, unsigned int j, unsigned int k)
+  {
+    return static_cast<KeyType>(i + BinsPerComponent * (j + BinsPerComponent * k));
+  }
+
+  /** Unpack a key into the index of the dense histogram image. */
+  static IndexType
+  UnpackKey(KeyType key)
+  {
+    IndexType index;
+    index[0] = key % BinsPerComponent;
+    index[1] = (key / BinsPerComponent) % BinsPerComponent;
+    index[2] = key / (BinsPerComponent * BinsPerComponent);
+    return index;
+  }
+
+  /** Remove all entries. */
+  void
+  Clear();
+
+  /** Add the counts of an unordered map to the histogram. Bins whose
+   * count is zero, including after a narrow count wraps, hold no entry. */
+  void
+  Insert(const MapType & counts);
+
+  /** Replace the entries with the non-zero bins of a dense count array
+   * indexed by key. */
+  void
+  SetDenseCounts(const CountType * counts);
+
+  /** Entries sorted by key. */
+  const EntryContainerType &
+  GetEntries() const
+  {
+    return m_Entries;
+  }
+
+  SizeValueType
+  GetNumberOfEntries() const
+  {
+    return m_Entries.size();
+  }
+
+  /** Count stored for a key, zero when the bin is empty. */
+  CountType
+  GetCount(KeyType key) const;
+
+  /** Build the equivalent 256x256x256 dense histogram image. */
+  typename DenseImageType::Pointer
+  GetDenseImage() const;
+
+  /** Stream the entries to disk in the compact format. */
+  void
+  Write(const std::string & fileName) const;
+
+  /** Load entries written by Write(). Throws when the file is truncated
+   * or its keys are not strictly increasing within the colour cube. */
+  void
+  Read(const std::string & fileName);
+
+  /** True when the file name carries the sparse histogram extension. */
+  static bool
+  IsSparseFileName(const std::string & fileName)
+  {
+    const std::string extension = ".sch";
+    return fileName.size() >= extension.size() &&
+           fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+  }
+
+protected:
+  SparseColorHistogram() = default;
+  ~SparseColorHistogram() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  EntryContainerType m_Entries{};
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkSparseColorHistogram.hxx"
+#endif
+
+#endif
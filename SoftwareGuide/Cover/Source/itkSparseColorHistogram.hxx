@@ -0,0 +1,287 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkSparseColorHistogram.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkSparseColorHistogram_hxx
+#define itkSparseColorHistogram_hxx
+
+#include <algorithm>
+#include <fstream>
+
+namespace itk
+{
+
+namespace SparseColorHistogramDetail
+{
+constexpr char Magic[4] = { 'S', 'C', 'H', '1' };
+
+inline void
+WriteVarint(std::ostream & os, std::uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    os.put(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  os.put(static_cast<char>(value));
+}
+
+inline bool
+ReadVarint(std::istream & is, std::uint64_t & value)
+{
+  value = 0;
+  for (unsigned int shift = 0; shift < 64; shift += 7)
+  {
+    const int byte = is.get();
+    if (byte == std::char_traits<char>::eof())
+    {
+      return false;
+    }
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+} // end namespace SparseColorHistogramDetail
+
+
+template <typename TCount>
+void
+SparseColorHistogram<TCount>::Clear()
+{
+  m_Entries.clear();
+  this->Modified();
+}
+
+
+template <typename TCount>
+void
+SparseColorHistogram<TCount>::Insert(const MapType & counts)
+{
+  EntryContainerType incoming(counts.begin(), counts.end());
+  std::sort(incoming.begin(), incoming.end());
+
+  EntryContainerType merged;
+  merged.reserve(m_Entries.size() + incoming.size());
+
+  // A count that wrapped to zero drops its entry, as SetDenseCounts drops
+  // the empty bins, so both paths give the same entries.
+  const auto append = [&merged](KeyType key, CountType count) {
+    if (count != CountType{})
+    {
+      merged.emplace_back(key, count);
+    }
+  };
+
+  auto current = m_Entries.cbegin();
+  auto added = incoming.cbegin();
+  while (current != m_Entries.cend() || added != incoming.cend())
+  {
+    if (added == incoming.cend() || (current != m_Entries.cend() && current->first < added->first))
+    {
+      append(current->first, current->second);
+      ++current;
+    }
+    else if (current == m_Entries.cend() || added->first < current->first)
+    {
+      append(added->first, added->second);
+      ++added;
+    }
+    else
+    {
+      append(current->first, static_cast<CountType>(current->second + added->second));
+      ++current;
+      ++added;
+    }
+  }
+
+  m_Entries.swap(merged);
+  this->Modified();
+}
+
+
+template <typename TCount>
+void
+SparseColorHistogram<TCount>::SetDenseCounts(const CountType * counts)
+{
+  m_Entries.clear();
+
+  constexpr KeyType numberOfBins = BinsPerComponent * BinsPerComponent * BinsPerComponent;
+  for (KeyType key = 0; key < numberOfBins; ++key)
+  {
+    if (counts[key] != CountType{})
+    {
+      m_Entries.emplace_back(key, counts[key]);
+    }
+  }
+  this->Modified();
+}
+
+
+template <typename TCount>
+auto
+SparseColorHistogram<TCount>::GetCount(KeyType key) const -> CountType
+{
+  const auto it = std::lower_bound(
+    m_Entries.cbegin(), m_Entries.cend(), key, [](const EntryType & entry, KeyType k) { return entry.first < k; });
+  if (it != m_Entries.cend() && it->first == key)
+  {
+    return it->second;
+  }
+  return CountType{};
+}
+
+
+template <typename TCount>
+auto
+SparseColorHistogram<TCount>::GetDenseImage() const -> typename DenseImageType::Pointer
+{
+  typename DenseImageType::SizeType size;
+  size.Fill(BinsPerComponent);
+
+  typename DenseImageType::IndexType start;
+  start.Fill(0);
+
+  typename DenseImageType::RegionType region;
+  region.SetSize(size);
+  region.SetIndex(start);
+
+  auto image = DenseImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  image->FillBuffer(CountType{});
+
+  CountType * buffer = image->GetBufferPointer();
+  for (const auto & entry : m_Entries)
+  {
+    buffer[entry.first] = entry.second;
+  }
+
+  return image;
+}
+
+
+template <typename TCount>
+void
+SparseColorHistogram<TCount>::Write(const std::string & fileName) const
+{
+  std::ofstream os(fileName, std::ios::binary);
+  if (!os)
+  {
+    itkExceptionMacro("Cannot open " << fileName << " for writing");
+  }
+
+  os.write(SparseColorHistogramDetail::Magic, sizeof(SparseColorHistogramDetail::Magic));
+  os.put(static_cast<char>(sizeof(CountType)));
+  SparseColorHistogramDetail::WriteVarint(os, m_Entries.size());
+
+  KeyType previousKey = 0;
+  for (const auto & entry : m_Entries)
+  {
+    SparseColorHistogramDetail::WriteVarint(os, entry.first - previousKey);
+    SparseColorHistogramDetail::WriteVarint(os, static_cast<std::uint64_t>(entry.second));
+    previousKey = entry.first;
+  }
+
+  if (!os)
+  {
+    itkExceptionMacro("Error while writing " << fileName);
+  }
+}
+
+
+template <typename TCount>
+void
+SparseColorHistogram<TCount>::Read(const std::string & fileName)
+{
+  std::ifstream is(fileName, std::ios::binary);
+  if (!is)
+  {
+    itkExceptionMacro("Cannot open " << fileName << " for reading");
+  }
+
+  char magic[sizeof(SparseColorHistogramDetail::Magic)];
+  is.read(magic, sizeof(magic));
+  if (!is || !std::equal(magic, magic + sizeof(magic), SparseColorHistogramDetail::Magic))
+  {
+    itkExceptionMacro(<< fileName << " is not a sparse colour histogram");
+  }
+
+  const int countBytes = is.get();
+  if (countBytes <= 0 || countBytes > 8)
+  {
+    itkExceptionMacro(<< fileName << " has an invalid count width");
+  }
+  if (static_cast<unsigned int>(countBytes) > sizeof(CountType))
+  {
+    itkWarningMacro(<< fileName << " stores " << countBytes * 8 << " bit counts, they are narrowed to "
+                    << sizeof(CountType) * 8 << " bits");
+  }
+
+  std::uint64_t numberOfEntries;
+  if (!SparseColorHistogramDetail::ReadVarint(is, numberOfEntries))
+  {
+    itkExceptionMacro(<< fileName << " is truncated");
+  }
+
+  constexpr std::uint64_t numberOfBins = BinsPerComponent * BinsPerComponent * BinsPerComponent;
+
+  EntryContainerType entries;
+  entries.reserve(std::min(numberOfEntries, numberOfBins));
+
+  std::uint64_t key = 0;
+  for (std::uint64_t n = 0; n < numberOfEntries; ++n)
+  {
+    std::uint64_t delta;
+    std::uint64_t count;
+    if (!SparseColorHistogramDetail::ReadVarint(is, delta) || !SparseColorHistogramDetail::ReadVarint(is, count))
+    {
+      itkExceptionMacro(<< fileName << " is truncated");
+    }
+    // The keys are stored in increasing order, as deltas from the previous
+    // one; checking the delta against the room left also rules out a
+    // wrapped key.
+    if (n > 0 && delta == 0)
+    {
+      itkExceptionMacro(<< fileName << " repeats a key");
+    }
+    if (delta >= numberOfBins - key)
+    {
+      itkExceptionMacro(<< fileName << " contains a key outside of the colour cube");
+    }
+    key += delta;
+    entries.emplace_back(static_cast<KeyType>(key), static_cast<CountType>(count));
+  }
+
+  m_Entries.swap(entries);
+  this->Modified();
+}
+
+
+template <typename TCount>
+void
+SparseColorHistogram<TCount>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfEntries: " << m_Entries.size() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
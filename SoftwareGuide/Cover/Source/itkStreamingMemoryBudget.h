@@ -0,0 +1,58 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkStreamingMemoryBudget.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkStreamingMemoryBudget_h
+#define itkStreamingMemoryBudget_h
+
+#include "itkImageRegion.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+/** Number of slabs a streamed pipeline over \a region has to be split into
+ * so that one slab of every image it holds at once fits in the budget.
+ *
+ * \a bytesPerPixel is the sum of the pixel sizes of the images alive at
+ * the same time, for example input plus output for a filter that does not
+ * run in place. A budget of zero or less disables streaming. The result
+ * never exceeds the number of slices along the slowest dimension, which
+ * is how the writers split the region. */
+template <unsigned int VDimension>
+unsigned int
+ComputeNumberOfStreamDivisions(const ImageRegion<VDimension> & region,
+                               SizeValueType                   bytesPerPixel,
+                               double                          memoryBudgetInMegabytes)
+{
+  if (memoryBudgetInMegabytes <= 0.0)
+  {
+    return 1;
+  }
+
+  const double requiredBytes = static_cast<double>(region.GetNumberOfPixels()) * bytesPerPixel;
+  const double budgetBytes = memoryBudgetInMegabytes * 1024.0 * 1024.0;
+  const double divisions = std::ceil(requiredBytes / budgetBytes);
+
+  const double slices = static_cast<double>(region.GetSize(VDimension - 1));
+
+  return static_cast<unsigned int>(std::max(1.0, std::min(divisions, slices)));
+}
+
+} // end namespace itk
+
+#endif
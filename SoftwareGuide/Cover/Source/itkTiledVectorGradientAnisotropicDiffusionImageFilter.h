@@ -0,0 +1,222 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkTiledVectorGradientAnisotropicDiffusionImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkTiledVectorGradientAnisotropicDiffusionImageFilter_h
+#define itkTiledVectorGradientAnisotropicDiffusionImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkNumericTraits.h"
+
+#include <cstdint>
+
+namespace itk
+{
+
+/** \class TiledVectorGradientAnisotropicDiffusionImageFilter
+ * \brief VectorGradientAnisotropicDiffusionImageFilter advancing several
+ * iterations per cache-sized tile.
+ *
+ * The update of a pixel is that of
+ * VectorGradientNDAnisotropicDiffusionFunction, with the image spacing and
+ * zero flux boundaries, but the iterations run in blocks of
+ * IterationsPerBlock. For each block the image is split into tiles of
+ * TileSize pixels along every dimension, processed in parallel. A tile is
+ * loaded with a halo of one pixel per iteration and advanced through all
+ * the iterations of the block in a private buffer that stays in cache,
+ * each iteration shrinking the valid region by one pixel, and only the
+ * tile itself is written back. A block therefore reads and writes the
+ * image once instead of once per iteration, at the cost of recomputing the
+ * halos.
+ *
+ * The conductance is scaled by the average squared gradient magnitude at
+ * the start of each block, which is ConductanceScalingUpdateInterval set to
+ * IterationsPerBlock in AnisotropicDiffusionImageFilter. The tiles compute
+ * it for the next block from their last iteration, with one more pixel of
+ * halo, so it costs no extra pass. IterationsPerBlock defaults to one,
+ * which gives the per-iteration scaling of
+ * VectorGradientAnisotropicDiffusionImageFilter; larger values turn the
+ * blocking on and trade that scaling for bandwidth.
+ *
+ * Two float copies of the image hold the state between blocks, the same
+ * memory as the output and update buffers of the dense filter. With
+ * UseFixedPointState they hold 16-bit fixed point instead, spanning the
+ * range of the input: the tiles still compute in float, and the state takes
+ * half the memory and bandwidth. The quantization step is the input range
+ * over 65535, a 256th of a level for 8-bit data. The diffusion only stays
+ * within the range of the input for a stable TimeStep, at most the smallest
+ * spacing over 2^(ImageDimension+1), as AnisotropicDiffusionImageFilter
+ * warns; past it the fixed point state saturates, and the filter warns as
+ * well.
+ *
+ * The iterations stop early once the RMS change of the pixels, summed over
+ * the components, falls below MaximumRMSError, as in
+ * FiniteDifferenceImageFilter. The tiles accumulate the change of the last
+ * iteration of each block as they update it, and the test runs between
+ * blocks. It is off with MaximumRMSError at zero.
+ *
+ * The input is read, and the output written, directly by the tiles, so an
+ * 8-bit image needs no float copy. An integer output is clamped and
+ * truncated by the last iteration, in place of a CastImageFilter, with the
+ * values of the cast.
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT TiledVectorGradientAnisotropicDiffusionImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(TiledVectorGradientAnisotropicDiffusionImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = TiledVectorGradientAnisotropicDiffusionImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(TiledVectorGradientAnisotropicDiffusionImageFilter);
+
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  using InputImageType = TInputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+  using InputImageRegionType = typename InputImageType::RegionType;
+
+  using OutputImageType = TOutputImage;
+  using OutputPixelType = typename OutputImageType::PixelType;
+
+  /** Components of a pixel. */
+  static constexpr unsigned int VectorDimension = InputPixelType::Dimension;
+
+  /** State between blocks with UseFixedPointState. */
+  using FixedPointType = std::uint16_t;
+
+  itkSetMacro(NumberOfIterations, unsigned int);
+  itkGetConstMacro(NumberOfIterations, unsigned int);
+
+  itkSetMacro(TimeStep, double);
+  itkGetConstMacro(TimeStep, double);
+
+  itkSetMacro(ConductanceParameter, double);
+  itkGetConstMacro(ConductanceParameter, double);
+
+  /** Iterations advanced per tile before moving on. One, the default,
+   * refreshes the conductance scaling every iteration. */
+  itkSetClampMacro(IterationsPerBlock, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(IterationsPerBlock, unsigned int);
+
+  /** Pixels of a tile along every dimension, halo excluded. */
+  itkSetClampMacro(TileSize, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(TileSize, unsigned int);
+
+  /** Store the state between blocks as 16-bit fixed point rather than
+   * float. */
+  itkSetMacro(UseFixedPointState, bool);
+  itkGetConstMacro(UseFixedPointState, bool);
+  itkBooleanMacro(UseFixedPointState);
+
+  /** Stop once the RMS change of an iteration is below this. */
+  itkSetMacro(MaximumRMSError, double);
+  itkGetConstMacro(MaximumRMSError, double);
+
+  itkGetConstMacro(ElapsedIterations, unsigned int);
+  itkGetConstMacro(RMSChange, double);
+
+protected:
+  TiledVectorGradientAnisotropicDiffusionImageFilter() = default;
+  ~TiledVectorGradientAnisotropicDiffusionImageFilter() override = default;
+
+  /** The whole image is diffused. */
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** Average over the input of the squared gradient magnitude, summed over
+   * the components. Also sets the range of the fixed point state. */
+  double
+  AnalyzeInput();
+
+  /** Run the blocks of iterations with the state stored as \a TState,
+   * starting from the given average squared gradient magnitude. */
+  template <typename TState>
+  void
+  DiffuseBlocks(double average);
+
+  /** Advance a tile by a number of iterations, reading the state from
+   * \a source, or the input when it is null, and writing it to \a target,
+   * or the output when it is null. Returns the sum over the tile of the
+   * squared gradient magnitude after the last iteration, when \a halo
+   * leaves the room to compute it, and sets \a change to the sum of the
+   * squared change of the last iteration. */
+  template <typename TState>
+  double
+  ProcessTile(SizeValueType  tile,
+              unsigned int   iterations,
+              unsigned int   halo,
+              float          conductance,
+              const TState * source,
+              TState *       target,
+              double &       change) const;
+
+  /** Conversions between the state and float. */
+  float
+  Decode(float state) const;
+  float
+  Decode(FixedPointType state) const;
+  void
+  Encode(float value, float & state) const;
+  void
+  Encode(float value, FixedPointType & state) const;
+
+  unsigned int m_NumberOfIterations{ 0 };
+  double       m_TimeStep{ 0.125 };
+  double       m_ConductanceParameter{ 1.0 };
+  unsigned int m_IterationsPerBlock{ 1 };
+  unsigned int m_TileSize{ 32 };
+  bool         m_UseFixedPointState{ false };
+  double       m_MaximumRMSError{ 0.0 };
+  unsigned int m_ElapsedIterations{ 0 };
+  double       m_RMSChange{ 0.0 };
+
+  /** Geometry of the image and of the tile grid while the filter runs. */
+  SizeValueType m_Size[ImageDimension]{};
+  SizeValueType m_Stride[ImageDimension]{};
+  SizeValueType m_GridSize[ImageDimension]{};
+  float         m_Scale[ImageDimension]{};
+
+  /** Value of the fixed point state zero, and of its unit. */
+  float m_StateOrigin{ 0.0f };
+  float m_StateStep{ 0.0f };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkTiledVectorGradientAnisotropicDiffusionImageFilter.hxx"
+#endif
+
+#endif
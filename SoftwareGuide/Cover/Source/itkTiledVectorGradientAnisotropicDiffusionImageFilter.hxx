@@ -0,0 +1,616 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkTiledVectorGradientAnisotropicDiffusionImageFilter.hxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or https://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef itkTiledVectorGradientAnisotropicDiffusionImageFilter_hxx
+#define itkTiledVectorGradientAnisotropicDiffusionImageFilter_hxx
+
+#include "itkMultiThreaderBase.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+void
+TiledVectorGradientAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  if (this->GetInput())
+  {
+    auto * input = const_cast<InputImageType *>(this->GetInput());
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+TiledVectorGradientAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(
+  DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+TiledVectorGradientAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  const InputImageType *     input = this->GetInput();
+  OutputImageType *          output = this->GetOutput();
+  const InputImageRegionType region = input->GetBufferedRegion();
+
+  output->SetBufferedRegion(output->GetRequestedRegion());
+  output->Allocate();
+
+  this->GetMultiThreader()->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  SizeValueType stride = 1;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    m_Size[d] = region.GetSize(d);
+    m_Stride[d] = stride;
+    m_GridSize[d] = (m_Size[d] + m_TileSize - 1) / m_TileSize;
+    m_Scale[d] = static_cast<float>(1.0 / input->GetSpacing()[d]);
+    stride *= m_Size[d];
+  }
+
+  m_ElapsedIterations = 0;
+  m_RMSChange = 0.0;
+
+  // The same test as AnisotropicDiffusionImageFilter. Past it the diffusion
+  // may leave the range of the input, which the fixed point state clamps.
+  double minimumSpacing = input->GetSpacing()[0];
+  for (unsigned int d = 1; d < ImageDimension; ++d)
+  {
+    minimumSpacing = std::min(minimumSpacing, input->GetSpacing()[d]);
+  }
+  const double stableTimeStep = minimumSpacing / std::pow(2.0, static_cast<double>(ImageDimension) + 1.0);
+  if (m_TimeStep > stableTimeStep)
+  {
+    itkWarningMacro(<< "Anisotropic diffusion unstable time step: " << m_TimeStep
+                    << ". Stable time step for this image must be smaller than " << stableTimeStep);
+  }
+
+  const double average = m_NumberOfIterations > 0 && region.GetNumberOfPixels() > 0 ? this->AnalyzeInput() : 0.0;
+  if (m_UseFixedPointState)
+  {
+    this->DiffuseBlocks<FixedPointType>(average);
+  }
+  else
+  {
+    this->DiffuseBlocks<float>(average);
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+template <typename TState>
+void
+TiledVectorGradientAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::DiffuseBlocks(double average)
+{
+  const SizeValueType numberOfPixels = this->GetInput()->GetBufferedRegion().GetNumberOfPixels();
+  if (numberOfPixels == 0)
+  {
+    return;
+  }
+
+  SizeValueType numberOfTiles = 1;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    numberOfTiles *= m_GridSize[d];
+  }
+
+  // State between blocks. The first block reads the input and the last one
+  // writes the output.
+  std::vector<TState> source;
+  std::vector<TState> target;
+  std::vector<double> tileSums(numberOfTiles);
+  std::vector<double> tileChanges(numberOfTiles);
+  do
+  {
+    const unsigned int iterations = std::min(m_IterationsPerBlock, m_NumberOfIterations - m_ElapsedIterations);
+    const bool         last = m_ElapsedIterations + iterations == m_NumberOfIterations;
+    const unsigned int halo = last ? iterations : iterations + 1;
+    const auto         conductance =
+      static_cast<float>(average * m_ConductanceParameter * m_ConductanceParameter * -2.0);
+
+    if (!last)
+    {
+      target.resize(numberOfPixels * VectorDimension);
+    }
+    const TState * blockSource = m_ElapsedIterations > 0 ? source.data() : nullptr;
+    TState *       blockTarget = last ? nullptr : target.data();
+
+    this->GetMultiThreader()->ParallelizeArray(
+      0,
+      numberOfTiles,
+      [&](SizeValueType tile) {
+        tileSums[tile] =
+          this->ProcessTile(tile, iterations, halo, conductance, blockSource, blockTarget, tileChanges[tile]);
+      },
+      nullptr);
+
+    m_ElapsedIterations += iterations;
+
+    double change = 0.0;
+    for (const double tileChange : tileChanges)
+    {
+      change += tileChange;
+    }
+    m_RMSChange = std::sqrt(change / static_cast<double>(numberOfPixels));
+
+    if (!last && m_RMSChange < m_MaximumRMSError)
+    {
+      // Converged before the last block: write the state to the output.
+      const TState * state = target.data();
+      this->GetMultiThreader()->ParallelizeArray(
+        0,
+        numberOfTiles,
+        [&](SizeValueType tile) {
+          this->template ProcessTile<TState>(tile, 0, 0, 0.0f, state, nullptr, tileChanges[tile]);
+        },
+        nullptr);
+      break;
+    }
+
+    if (!last)
+    {
+      double sum = 0.0;
+      for (const double tileSum : tileSums)
+      {
+        sum += tileSum;
+      }
+      average = sum / static_cast<double>(numberOfPixels);
+
+      source.swap(target);
+      if (m_NumberOfIterations - m_ElapsedIterations <= m_IterationsPerBlock)
+      {
+        // The last block writes the output instead.
+        target = std::vector<TState>();
+      }
+    }
+  } while (m_ElapsedIterations < m_NumberOfIterations);
+
+  itkDebugMacro(<< "Stopped after " << m_ElapsedIterations << " iterations with an RMS change of " << m_RMSChange);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+double
+TiledVectorGradientAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::AnalyzeInput()
+{
+  constexpr unsigned int SlowDimension = ImageDimension - 1;
+
+  const InputPixelType * input = this->GetInput()->GetBufferPointer();
+  const SizeValueType    numberOfPixels = this->GetInput()->GetBufferedRegion().GetNumberOfPixels();
+  const SizeValueType    length = m_Size[0];
+  const SizeValueType    numberOfSlices = ImageDimension > 1 ? m_Size[SlowDimension] : 1;
+  const SizeValueType    linesPerSlice = numberOfPixels / length / numberOfSlices;
+
+  std::vector<double> sliceSums(numberOfSlices);
+  std::vector<float>  sliceMinima(numberOfSlices);
+  std::vector<float>  sliceMaxima(numberOfSlices);
+
+  this->GetMultiThreader()->ParallelizeArray(
+    0,
+    numberOfSlices,
+    [&](SizeValueType slice) {
+      double sum = 0.0;
+      float  minimum = NumericTraits<float>::max();
+      float  maximum = NumericTraits<float>::NonpositiveMin();
+      for (SizeValueType line = slice * linesPerSlice; line < (slice + 1) * linesPerSlice; ++line)
+      {
+        // Neighbours along the slower dimensions, clamped to the image.
+        SizeValueType plus[ImageDimension];
+        SizeValueType minus[ImageDimension];
+        SizeValueType rest = line;
+        for (unsigned int d = 1; d < ImageDimension; ++d)
+        {
+          const SizeValueType position = rest % m_Size[d];
+          rest /= m_Size[d];
+          plus[d] = position + 1 < m_Size[d] ? m_Stride[d] : 0;
+          minus[d] = position > 0 ? m_Stride[d] : 0;
+        }
+
+        const InputPixelType * pixels = input + line * length;
+        for (SizeValueType x = 0; x < length; ++x)
+        {
+          plus[0] = x + 1 < length ? 1 : 0;
+          minus[0] = x > 0 ? 1 : 0;
+          for (unsigned int k = 0; k < VectorDimension; ++k)
+          {
+            const auto value = static_cast<float>(pixels[x][k]);
+            minimum = std::min(minimum, value);
+            maximum = std::max(maximum, value);
+          }
+          for (unsigned int d = 0; d < ImageDimension; ++d)
+          {
+            for (unsigned int k = 0; k < VectorDimension; ++k)
+            {
+              const auto  forward = static_cast<float>(pixels[x + plus[d]][k]);
+              const auto  backward = static_cast<float>(pixels[x - minus[d]][k]);
+              const float derivative = 0.5f * (forward - backward) * m_Scale[d];
+              sum += derivative * derivative;
+            }
+          }
+        }
+      }
+      sliceSums[slice] = sum;
+      sliceMinima[slice] = minimum;
+      sliceMaxima[slice] = maximum;
+    },
+    nullptr);
+
+  double sum = 0.0;
+  for (const double sliceSum : sliceSums)
+  {
+    sum += sliceSum;
+  }
+
+  // The diffusion keeps every component within the range of the input, so
+  // the fixed point state spans that range.
+  const float minimum = *std::min_element(sliceMinima.begin(), sliceMinima.end());
+  const float maximum = *std::max_element(sliceMaxima.begin(), sliceMaxima.end());
+  m_StateOrigin = minimum;
+  m_StateStep = (maximum - minimum) / static_cast<float>(NumericTraits<FixedPointType>::max());
+
+  return sum / static_cast<double>(numberOfPixels);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+inline float
+TiledVectorGradientAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::Decode(float state) const
+{
+  return state;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+inline float
+TiledVectorGradientAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::Decode(FixedPointType state) const
+{
+  return m_StateOrigin + static_cast<float>(state) * m_StateStep;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+inline void
+TiledVectorGradientAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::Encode(float value, float & state) const
+{
+  state = value;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+inline void
+TiledVectorGradientAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::Encode(float            value,
+                                                                                      FixedPointType & state) const
+{
+  constexpr auto maximum = static_cast<float>(NumericTraits<FixedPointType>::max());
+
+  // A constant input has no step and every value encodes to zero.
+  const float level = m_StateStep > 0.0f ? (value - m_StateOrigin) / m_StateStep : 0.0f;
+  state = static_cast<FixedPointType>(std::min(std::max(level + 0.5f, 0.0f), maximum));
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+template <typename TState>
+double
+TiledVectorGradientAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::ProcessTile(SizeValueType  tile,
+                                                                                           unsigned int   iterations,
+                                                                                           unsigned int   halo,
+                                                                                           float          conductance,
+                                                                                           const TState * source,
+                                                                                           TState *       target,
+                                                                                           double &       change) const
+{
+  constexpr unsigned int C = VectorDimension;
+
+  // The tile and its buffer, which adds the halo, in image coordinates.
+  IndexValueType tileLower[ImageDimension];
+  IndexValueType tileUpper[ImageDimension];
+  IndexValueType lower[ImageDimension];
+  IndexValueType extent[ImageDimension];
+  SizeValueType  stride[ImageDimension];
+  SizeValueType  volume = 1;
+  SizeValueType  rest = tile;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    const auto size = static_cast<IndexValueType>(m_Size[d]);
+    tileLower[d] = static_cast<IndexValueType>(rest % m_GridSize[d] * m_TileSize);
+    tileUpper[d] = std::min<IndexValueType>(tileLower[d] + m_TileSize, size);
+    lower[d] = std::max<IndexValueType>(tileLower[d] - halo, 0);
+    extent[d] = std::min<IndexValueType>(tileUpper[d] + halo, size) - lower[d];
+    stride[d] = volume;
+    volume *= static_cast<SizeValueType>(extent[d]);
+    rest /= m_GridSize[d];
+  }
+
+  // Visit the lines of the buffer between two corners, relative to the
+  // buffer, with the offset of the line in the buffer and in the image.
+  const auto forEachLine = [&](const IndexValueType * from, const IndexValueType * to, const auto & visit) {
+    IndexValueType position[ImageDimension];
+    std::copy(from, from + ImageDimension, position);
+    while (true)
+    {
+      SizeValueType bufferOffset = 0;
+      SizeValueType imageOffset = 0;
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        bufferOffset += static_cast<SizeValueType>(position[d]) * stride[d];
+        imageOffset += static_cast<SizeValueType>(lower[d] + position[d]) * m_Stride[d];
+      }
+      visit(position, bufferOffset, imageOffset);
+
+      unsigned int d = 1;
+      while (d < ImageDimension && ++position[d] == to[d])
+      {
+        position[d] = from[d];
+        ++d;
+      }
+      if (d >= ImageDimension)
+      {
+        break;
+      }
+    }
+  };
+
+  IndexValueType bufferFrom[ImageDimension];
+  IndexValueType tileFrom[ImageDimension];
+  IndexValueType tileTo[ImageDimension];
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    bufferFrom[d] = 0;
+    tileFrom[d] = tileLower[d] - lower[d];
+    tileTo[d] = tileUpper[d] - lower[d];
+  }
+
+  std::vector<float> current(volume * C);
+  std::vector<float> next(volume * C);
+
+  const InputPixelType * input = this->GetInput()->GetBufferPointer();
+  forEachLine(bufferFrom, extent, [&](const IndexValueType *, SizeValueType bufferOffset, SizeValueType imageOffset) {
+    float * values = current.data() + bufferOffset * C;
+    if (source)
+    {
+      const TState * state = source + imageOffset * C;
+      for (IndexValueType i = 0; i < extent[0] * C; ++i)
+      {
+        values[i] = this->Decode(state[i]);
+      }
+    }
+    else
+    {
+      for (IndexValueType x = 0; x < extent[0]; ++x)
+      {
+        for (unsigned int k = 0; k < C; ++k)
+        {
+          values[x * C + k] = static_cast<float>(input[imageOffset + x][k]);
+        }
+      }
+    }
+  });
+
+  const auto timeStep = static_cast<float>(m_TimeStep);
+
+  change = 0.0;
+
+  for (unsigned int t = 1; t <= iterations; ++t)
+  {
+    // Pixels still valid after this iteration.
+    const auto     margin = static_cast<IndexValueType>(halo - t);
+    IndexValueType from[ImageDimension];
+    IndexValueType to[ImageDimension];
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      from[d] = std::max<IndexValueType>(tileLower[d] - margin, 0) - lower[d];
+      to[d] = std::min<IndexValueType>(tileUpper[d] + margin, static_cast<IndexValueType>(m_Size[d])) - lower[d];
+    }
+
+    forEachLine(from, to, [&](const IndexValueType * position, SizeValueType bufferOffset, SizeValueType) {
+      // Neighbours in the buffer, clamped at its edges, which are either the
+      // image border or beyond the pixels this iteration reads.
+      SizeValueType plus[ImageDimension];
+      SizeValueType minus[ImageDimension];
+      bool          tileLine = t == iterations;
+      for (unsigned int d = 1; d < ImageDimension; ++d)
+      {
+        plus[d] = position[d] + 1 < extent[d] ? stride[d] : 0;
+        minus[d] = position[d] > 0 ? stride[d] : 0;
+        tileLine = tileLine && position[d] >= tileFrom[d] && position[d] < tileTo[d];
+      }
+
+      for (IndexValueType x = from[0]; x < to[0]; ++x)
+      {
+        plus[0] = x + 1 < extent[0] ? 1 : 0;
+        minus[0] = x > 0 ? 1 : 0;
+
+        const SizeValueType b = bufferOffset + static_cast<SizeValueType>(x - from[0]);
+        const float *       v = current.data();
+        const auto          at = [v](SizeValueType offset, unsigned int k) { return v[offset * VectorDimension + k]; };
+
+        float dx[ImageDimension][C];
+        for (unsigned int i = 0; i < ImageDimension; ++i)
+        {
+          for (unsigned int k = 0; k < C; ++k)
+          {
+            dx[i][k] = 0.5f * (at(b + plus[i], k) - at(b - minus[i], k)) * m_Scale[i];
+          }
+        }
+
+        float delta[C] = {};
+        for (unsigned int i = 0; i < ImageDimension; ++i)
+        {
+          float forward[C];
+          float backward[C];
+          float magnitude = 0.0f;
+          float magnitudeBackward = 0.0f;
+          for (unsigned int k = 0; k < C; ++k)
+          {
+            forward[k] = (at(b + plus[i], k) - at(b, k)) * m_Scale[i];
+            backward[k] = (at(b, k) - at(b - minus[i], k)) * m_Scale[i];
+            magnitude += forward[k] * forward[k];
+            magnitudeBackward += backward[k] * backward[k];
+          }
+
+          for (unsigned int j = 0; j < ImageDimension; ++j)
+          {
+            if (j == i)
+            {
+              continue;
+            }
+            for (unsigned int k = 0; k < C; ++k)
+            {
+              const float augmented =
+                0.5f * (at(b + plus[i] + plus[j], k) - at(b + plus[i] - minus[j], k)) * m_Scale[j];
+              const float diminished =
+                0.5f * (at(b - minus[i] + plus[j], k) - at(b - minus[i] - minus[j], k)) * m_Scale[j];
+              magnitude += 0.25f * (dx[j][k] + augmented) * (dx[j][k] + augmented);
+              magnitudeBackward += 0.25f * (dx[j][k] + diminished) * (dx[j][k] + diminished);
+            }
+          }
+
+          float cx = 0.0f;
+          float cxd = 0.0f;
+          if (conductance != 0.0f)
+          {
+            cx = std::exp(magnitude / conductance);
+            cxd = std::exp(magnitudeBackward / conductance);
+          }
+          for (unsigned int k = 0; k < C; ++k)
+          {
+            delta[k] += forward[k] * cx - backward[k] * cxd;
+          }
+        }
+
+        // The change of the last iteration, over the tile itself.
+        const bool tilePixel = tileLine && x >= tileFrom[0] && x < tileTo[0];
+        for (unsigned int k = 0; k < C; ++k)
+        {
+          const float update = timeStep * delta[k];
+          next[b * C + k] = at(b, k) + update;
+          if (tilePixel)
+          {
+            change += update * update;
+          }
+        }
+      }
+    });
+
+    current.swap(next);
+  }
+
+  // Squared gradient magnitude of the tile for the next block, when the
+  // halo still holds valid neighbours.
+  double sum = 0.0;
+  if (halo > iterations)
+  {
+    forEachLine(tileFrom, tileTo, [&](const IndexValueType * position, SizeValueType bufferOffset, SizeValueType) {
+      SizeValueType plus[ImageDimension];
+      SizeValueType minus[ImageDimension];
+      for (unsigned int d = 1; d < ImageDimension; ++d)
+      {
+        plus[d] = position[d] + 1 < extent[d] ? stride[d] : 0;
+        minus[d] = position[d] > 0 ? stride[d] : 0;
+      }
+      for (IndexValueType x = tileFrom[0]; x < tileTo[0]; ++x)
+      {
+        plus[0] = x + 1 < extent[0] ? 1 : 0;
+        minus[0] = x > 0 ? 1 : 0;
+
+        const SizeValueType b = bufferOffset + static_cast<SizeValueType>(x - tileFrom[0]);
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+          for (unsigned int k = 0; k < C; ++k)
+          {
+            const float forward = current[(b + plus[d]) * C + k];
+            const float backward = current[(b - minus[d]) * C + k];
+            const float derivative = 0.5f * (forward - backward) * m_Scale[d];
+            sum += derivative * derivative;
+          }
+        }
+      }
+    });
+  }
+
+  // An integer output is clamped and truncated here, as a CastImageFilter
+  // would truncate it.
+  using OutputValueType = typename OutputPixelType::ValueType;
+  constexpr bool    integerOutput = NumericTraits<OutputValueType>::is_integer;
+  const auto        outputMinimum = static_cast<float>(NumericTraits<OutputValueType>::NonpositiveMin());
+  const auto        outputMaximum = static_cast<float>(NumericTraits<OutputValueType>::max());
+  OutputPixelType * output = this->GetOutput()->GetBufferPointer();
+  forEachLine(tileFrom, tileTo, [&](const IndexValueType *, SizeValueType bufferOffset, SizeValueType imageOffset) {
+    const float * values = current.data() + bufferOffset * C;
+    const auto    length = tileTo[0] - tileFrom[0];
+    if (target)
+    {
+      TState * state = target + imageOffset * C;
+      for (IndexValueType i = 0; i < length * C; ++i)
+      {
+        this->Encode(values[i], state[i]);
+      }
+    }
+    else
+    {
+      for (IndexValueType x = 0; x < length; ++x)
+      {
+        for (unsigned int k = 0; k < C; ++k)
+        {
+          float value = values[x * C + k];
+          if (integerOutput)
+          {
+            value = std::min(std::max(value, outputMinimum), outputMaximum);
+          }
+          output[imageOffset + x][k] = static_cast<OutputValueType>(value);
+        }
+      }
+    }
+  });
+
+  return sum;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+TiledVectorGradientAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                                         Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfIterations: " << m_NumberOfIterations << std::endl;
+  os << indent << "TimeStep: " << m_TimeStep << std::endl;
+  os << indent << "ConductanceParameter: " << m_ConductanceParameter << std::endl;
+  os << indent << "IterationsPerBlock: " << m_IterationsPerBlock << std::endl;
+  os << indent << "TileSize: " << m_TileSize << std::endl;
+  os << indent << "UseFixedPointState: " << (m_UseFixedPointState ? "On" : "Off") << std::endl;
+  os << indent << "MaximumRMSError: " << m_MaximumRMSError << std::endl;
+  os << indent << "ElapsedIterations: " << m_ElapsedIterations << std::endl;
+  os << indent << "RMSChange: " << m_RMSChange << std::endl;
+}
+
+} // end namespace itk
+
+#endif